@@ -0,0 +1,305 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <filesystem>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include "answergraph.h"
+#include "graphimage.h"
+#include "graphparser.h"
+#include "levenshtein.h"
+#include "chatsession.h"
+#include "chatlogic.h"
+#include "chatbot.h"
+#include "graphgenerator.h"
+
+// microbenchmarks for loading answer graphs, matching messages and copying / moving the chatbot
+// all results are written to stdout as one JSON document, so they can be compared across releases
+// usage: membotbench [--max-nodes <count>] [--min-time <seconds>] [--filter <name prefix>]
+
+// results are accumulated here, so the compiler cannot drop the benchmarked operations
+static volatile uint64_t sink = 0;
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::vector<std::pair<std::string, uint64_t>> params;
+    uint64_t iterations;
+    double nsPerOperation;
+};
+
+// runs every operation in batches of growing size until a batch takes at least the minimum time
+class BenchmarkRunner
+{
+private:
+    // proprietary members
+    double _minTime; // in seconds
+    std::string _filter;
+    std::vector<BenchmarkResult> _results;
+
+public:
+    // constructor / destructor
+    BenchmarkRunner(double minTime, std::string filter) : _minTime(minTime), _filter(std::move(filter)) {}
+
+    // proprietary functions
+    // a benchmark is selected if its name starts with the filter, a group of benchmarks if the filter may select one of them
+    bool IsSelected(const std::string &name) const { return name.compare(0, _filter.size(), _filter) == 0 || _filter.compare(0, name.size(), name) == 0; }
+    void Run(const std::string &name, std::vector<std::pair<std::string, uint64_t>> params, const std::function<void()> &operation);
+    void WriteJson(std::ostream &output) const;
+};
+
+void BenchmarkRunner::Run(const std::string &name, std::vector<std::pair<std::string, uint64_t>> params, const std::function<void()> &operation)
+{
+    if (!IsSelected(name))
+        return;
+
+    // the first call warms up caches (and the match cache of a graph), it is not measured
+    operation();
+
+    uint64_t iterations = 1;
+    double elapsed = 0.0;
+    while (true)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i)
+            operation();
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (elapsed >= _minTime)
+            break;
+        iterations *= elapsed > 0.0 ? std::min(10.0, std::max(2.0, 1.2 * _minTime / elapsed)) : 10.0;
+    }
+
+    _results.push_back(BenchmarkResult{name, std::move(params), iterations, elapsed * 1e9 / iterations});
+    std::cerr << name << ": " << _results.back().nsPerOperation << " ns" << std::endl;
+}
+
+void BenchmarkRunner::WriteJson(std::ostream &output) const
+{
+    output << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < _results.size(); ++i)
+    {
+        const BenchmarkResult &result = _results[i];
+        output << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name << "\", \"params\": {";
+        for (size_t j = 0; j < result.params.size(); ++j)
+            output << (j == 0 ? "" : ", ") << "\"" << result.params[j].first << "\": " << result.params[j].second;
+        output << "}, \"iterations\": " << result.iterations << ", \"ns_per_op\": " << result.nsPerOperation << "}";
+    }
+    output << "\n  ]\n}" << std::endl;
+}
+
+static std::string MakeWord(std::mt19937 &generator, size_t length)
+{
+    std::string word(length, 'a');
+    for (char &c : word)
+        c = 'a' + generator() % 26;
+    return word;
+}
+
+// tree-shaped graph in which every inner node has fanout children with one or two single-word keywords per edge
+static void WriteGraph(const std::string &filename, size_t numNodes, size_t fanout, std::mt19937 &generator)
+{
+    GraphGeneratorOptions options;
+    options.numNodes = numNodes;
+    options.fanout = fanout;
+    options.maxWordsPerKeyword = 1;
+    options.vocabularySize = std::max<size_t>(1000, numNodes);
+    options.seed = generator();
+
+    std::ofstream file(filename, std::ios::trunc);
+    GenerateGraph(options, file);
+}
+
+// queries close to the keywords of node (one character replaced), as produced by users with typos
+static std::vector<std::string> MakeQueries(const AnswerGraph &graph, const GraphNode &node, size_t count, std::mt19937 &generator)
+{
+    std::vector<std::string> queries;
+    KeywordIndex keywords = graph.GetKeywordIndex(node);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string query(keywords.GetKeywordAtIndex(generator() % keywords.GetNumberOfKeywords()));
+        query[generator() % query.size()] = 'A' + generator() % 26;
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+static void RunLoadBenchmarks(BenchmarkRunner &runner, size_t maxNodes, const std::filesystem::path &directory, std::mt19937 &generator)
+{
+    if (!runner.IsSelected("load"))
+        return;
+
+    for (size_t numNodes = 1000; numNodes <= maxNodes; numNodes *= 10)
+    {
+        std::string textFile = (directory / "membotbench_graph.txt").string();
+        std::string imageFile = (directory / "membotbench_graph.img").string();
+        WriteGraph(textFile, numNodes, 4, generator);
+
+        GraphRecordTable records;
+        std::vector<char> content;
+        {
+            std::ifstream file(textFile, std::ios::binary);
+            content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+
+        runner.Run("load_text", {{"nodes", numNodes}}, [&textFile]() {
+            AnswerGraph graph;
+            sink += graph.LoadFromFile(textFile);
+        });
+        runner.Run("load_parse", {{"nodes", numNodes}}, [&content, &records]() {
+            ParseGraphRecords(std::string_view(content.data(), content.size()), 1, records);
+            sink += records.nodes.size();
+        });
+
+        // compiled images are opened in place, so this mainly measures mapping the file
+        ParseGraphRecords(std::string_view(content.data(), content.size()), 1, records);
+        GraphImageBuilder builder;
+        builder.AddRecords(records);
+        builder.Write(imageFile);
+        runner.Run("load_image", {{"nodes", numNodes}}, [&imageFile]() {
+            AnswerGraph graph;
+            sink += graph.LoadFromFile(imageFile);
+        });
+
+        std::filesystem::remove(textFile);
+        std::filesystem::remove(imageFile);
+    }
+}
+
+static void RunDistanceBenchmarks(BenchmarkRunner &runner, std::mt19937 &generator)
+{
+    if (!runner.IsSelected("levenshtein"))
+        return;
+
+    for (size_t length : {4, 16, 64, 256})
+    {
+        std::string s1 = MakeWord(generator, length), s2 = MakeWord(generator, length);
+        runner.Run("levenshtein", {{"length", length}}, [&s1, &s2]() { sink += ComputeLevenshteinDistance(s1, s2); });
+        runner.Run("levenshtein_bounded", {{"length", length}, {"bound", 2}}, [&s1, &s2]() { sink += ComputeLevenshteinDistance(s1, s2, 2); });
+
+        // one pattern against a batch of 8 texts, as done when matching the keywords of a node
+        std::vector<std::string> texts;
+        for (size_t i = 0; i < 8; ++i)
+            texts.push_back(MakeWord(generator, length));
+        std::vector<std::string_view> views(texts.begin(), texts.end());
+        LevenshteinPattern pattern(s1);
+        runner.Run("levenshtein_batch", {{"length", length}, {"texts", 8}}, [&pattern, &views]() {
+            int distances[8];
+            pattern.ComputeDistances(views.data(), views.size(), distances);
+            sink += distances[0];
+        });
+    }
+}
+
+static void RunMatchingBenchmarks(BenchmarkRunner &runner, const std::filesystem::path &directory, std::mt19937 &generator)
+{
+    if (!runner.IsSelected("match") && !runner.IsSelected("receive_message"))
+        return;
+
+    for (size_t fanout : {4, 64, 1024, 16384})
+    {
+        std::string textFile = (directory / "membotbench_fanout.txt").string();
+        WriteGraph(textFile, fanout + 1, fanout, generator);
+
+        // the match cache is disabled, so every message is matched against all keywords of the node
+        std::shared_ptr<AnswerGraph> graph = std::make_shared<AnswerGraph>();
+        graph->SetMatchCacheCapacity(0);
+        graph->LoadFromFile(textFile);
+        std::filesystem::remove(textFile);
+        const GraphNode &root = *graph->GetRootNode();
+        std::vector<std::string> queries = MakeQueries(*graph, root, 1024, generator);
+
+        size_t next = 0;
+        runner.Run("match", {{"fanout", fanout}}, [&]() {
+            sink += graph->FindBestMatch(root, queries[next++ % queries.size()]).distance;
+        });
+
+        // a full message round trip: match at the root, move to the child and back to the root
+        ChatSession session(std::shared_ptr<const AnswerGraph>(graph), 1);
+        session.Start();
+        runner.Run("receive_message", {{"fanout", fanout}}, [&]() {
+            sink += session.ReceiveMessage(queries[next++ % queries.size()]).size();
+            sink += session.Start().size();
+        });
+
+        // repeated messages are answered from the match cache
+        std::shared_ptr<AnswerGraph> cachedGraph = std::make_shared<AnswerGraph>();
+        WriteGraph(textFile, fanout + 1, fanout, generator);
+        cachedGraph->LoadFromFile(textFile);
+        std::filesystem::remove(textFile);
+        const GraphNode &cachedRoot = *cachedGraph->GetRootNode();
+        std::vector<std::string> repeatedQueries = MakeQueries(*cachedGraph, cachedRoot, 64, generator);
+        runner.Run("match_cached", {{"fanout", fanout}}, [&]() {
+            sink += cachedGraph->FindBestMatch(cachedRoot, repeatedQueries[next++ % repeatedQueries.size()]).distance;
+        });
+    }
+}
+
+static void RunChatBotBenchmarks(BenchmarkRunner &runner, const std::filesystem::path &directory, std::mt19937 &generator)
+{
+    if (!runner.IsSelected("chatbot"))
+        return;
+
+    std::string textFile = (directory / "membotbench_chatbot.txt").string();
+    WriteGraph(textFile, 1000, 4, generator);
+    ChatLogic chatLogic;
+    chatLogic.SetResponseCallback([](const std::string &) {});
+    chatLogic.LoadAnswerGraphFromFile(textFile);
+    std::filesystem::remove(textFile);
+
+    ChatBot chatBot;
+    chatBot.SetChatLogicHandle(&chatLogic);
+    chatBot.StartSession(chatLogic.CreateSession(), true);
+
+    runner.Run("chatbot_copy_construct", {}, [&chatBot]() {
+        ChatBot copy(chatBot);
+        sink += copy.GetSession().IsStarted();
+    });
+    ChatBot target;
+    runner.Run("chatbot_copy_assign", {}, [&chatBot, &target]() {
+        target = chatBot;
+        sink += target.GetSession().IsStarted();
+    });
+    runner.Run("chatbot_move", {}, [&chatBot]() {
+        ChatBot moved(std::move(chatBot)); // move constructor
+        chatBot = std::move(moved);        // move assignment
+        sink += chatBot.GetSession().IsStarted();
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    size_t maxNodes = 1000000;
+    double minTime = 0.2;
+    std::string filter;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--max-nodes") == 0)
+            maxNodes = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--min-time") == 0)
+            minTime = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--filter") == 0)
+            filter = argv[i + 1];
+    }
+
+    // generated graphs are written to the temporary directory and removed after their benchmarks
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::mt19937 generator(42); // fixed seed, so every run measures the same graphs and queries
+
+    // progress is reported on stderr, as stdout carries the JSON document
+    BenchmarkRunner runner(minTime, filter);
+    RunLoadBenchmarks(runner, maxNodes, directory, generator);
+    RunDistanceBenchmarks(runner, generator);
+    RunMatchingBenchmarks(runner, directory, generator);
+    RunChatBotBenchmarks(runner, directory, generator);
+    runner.WriteJson(std::cout);
+
+    return 0;
+}
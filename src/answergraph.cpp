@@ -0,0 +1,209 @@
+#include <iostream>
+#include <thread>
+#include "graphparser.h"
+#include "levenshtein.h"
+#include "metrics.h"
+#include "memoryusage.h"
+#include "answergraph.h"
+
+const GraphNode *AnswerGraph::GetRootNode() const
+{
+    if (!IsLoaded() || _image.GetHeader().rootNode == invalidIndex)
+        return nullptr;
+
+    return GetNodeAtIndex(_image.GetHeader().rootNode);
+}
+
+KeywordIndex AnswerGraph::GetKeywordIndex(const GraphNode &node) const
+{
+    return KeywordIndex(_image.GetNodeKeywords() + node.GetFirstKeyword(), node.GetNumberOfKeywords(), _image.GetStringPool(), _image.GetEdges());
+}
+
+KeywordIndex AnswerGraph::GetAllKeywords() const
+{
+    return KeywordIndex(_image.GetNodeKeywords(), _image.GetHeader().numNodeKeywords, _image.GetStringPool(), _image.GetEdges());
+}
+
+GraphMemoryUsage AnswerGraph::GetMemoryUsage() const
+{
+    GraphMemoryUsage usage{};
+    if (IsLoaded())
+    {
+        const GraphImageHeader &header = _image.GetHeader();
+        usage.nodes = header.numNodes * sizeof(GraphNode);
+        usage.edges = header.numEdges * sizeof(GraphEdge);
+        usage.answers = header.numAnswers * sizeof(ImageString);
+        usage.keywords = header.numEdgeKeywords * sizeof(ImageString) + header.numNodeKeywords * sizeof(ImageKeyword);
+        usage.strings = header.stringPoolSize;
+        usage.isMapped = _arena.empty();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_keywordTreeMutex);
+        usage.keywordTrees = GetHeapMemoryUsage(_keywordTrees) + _keywordTrees.size() * sizeof(LazyIndex<KeywordTree>);
+        for (const auto &tree : _keywordTrees)
+        {
+            if (tree.second->isBuilt.load(std::memory_order_acquire))
+                usage.keywordTrees += tree.second->index.GetMemoryUsage();
+        }
+    }
+    if (_tokenIndex->isBuilt.load(std::memory_order_acquire))
+        usage.tokenIndex = _tokenIndex->index.GetMemoryUsage();
+    usage.matchCache = _matchCache.GetMemoryUsage();
+    return usage;
+}
+
+size_t AnswerGraph::GetNumberOfKeywordTrees() const
+{
+    std::lock_guard<std::mutex> lock(_keywordTreeMutex);
+    return _keywordTrees.size();
+}
+
+const KeywordTree &AnswerGraph::GetKeywordTree(uint32_t nodeIndex) const
+{
+    LazyIndex<KeywordTree> *tree;
+    {
+        std::lock_guard<std::mutex> lock(_keywordTreeMutex);
+        std::unique_ptr<LazyIndex<KeywordTree>> &entry = _keywordTrees[nodeIndex];
+        if (entry == nullptr)
+            entry = std::make_unique<LazyIndex<KeywordTree>>();
+        tree = entry.get();
+    }
+
+    // the tree is built without holding the lock, so matching at other nodes goes on in the meantime
+    std::call_once(tree->isBuilding, [this, tree, nodeIndex]() {
+        ScopedTimer timer(MetricHistogram::LoadIndexes);
+        tree->index.Build(GetKeywordIndex(*GetNodeAtIndex(nodeIndex)));
+        tree->isBuilt.store(true, std::memory_order_release);
+    });
+    return tree->index;
+}
+
+void AnswerGraph::BuildKeywordTrees()
+{
+    for (uint32_t i = 0; i < GetNumberOfNodes(); ++i)
+    {
+        if (GetNodeAtIndex(i)->GetNumberOfKeywords() >= minKeywordTreeSize)
+            GetKeywordTree(i);
+    }
+}
+
+const TokenIndex &AnswerGraph::GetTokenIndex() const
+{
+    std::call_once(_tokenIndex->isBuilding, [this]() {
+        ScopedTimer timer(MetricHistogram::LoadIndexes);
+        _tokenIndex->index.Build(GetAllKeywords());
+        _tokenIndex->isBuilt.store(true, std::memory_order_release);
+    });
+    return _tokenIndex->index;
+}
+
+void AnswerGraph::SetMatchingMode(MatchingMode mode)
+{
+    _matchingMode = mode;
+
+    // like while loading, the index of a text file is built right away (see LoadFromFile)
+    if (_matchingMode == MatchingMode::Tokens && IsLoaded() && !_arena.empty())
+        GetTokenIndex();
+}
+
+KeywordMatch AnswerGraph::FindBestMatch(const GraphNode &node, std::string_view query) const
+{
+    // matching is deterministic, so repeated messages at the same node are answered from the cache
+    ScopedTimer timer(MetricHistogram::Match);
+    uint32_t nodeIndex = &node - _image.GetNodes();
+    KeywordMatch match;
+    if (_matchCache.Find(nodeIndex, query, match))
+        return match;
+
+    match = MatchKeywords(node, query);
+    _matchCache.Insert(nodeIndex, query, match);
+    return match;
+}
+
+KeywordMatch AnswerGraph::MatchKeywords(const GraphNode &node, std::string_view query) const
+{
+    if (_matchingMode == MatchingMode::Tokens)
+    {
+        KeywordMatch match = GetTokenIndex().FindBestMatch(GetAllKeywords(), node.GetFirstKeyword(), node.GetNumberOfKeywords(), query);
+        if (match.edge != nullptr)
+            return match;
+    }
+
+    // a linear scan is faster for the typical handful of keywords, so trees are only used where they pay off
+    KeywordIndex index = GetKeywordIndex(node);
+    if (node.GetNumberOfKeywords() < minKeywordTreeSize)
+        return index.FindBestMatch(query);
+
+    LevenshteinPattern pattern(query);
+    return GetKeywordTree(&node - _image.GetNodes()).FindBestMatch(index, pattern);
+}
+
+bool AnswerGraph::LoadFromFile(const std::string &filename, const LoadProgressCallback &progressCallback)
+{
+    auto reportProgress = [&progressCallback](float progress) {
+        if (progressCallback)
+            progressCallback(progress);
+    };
+
+    // release a previously loaded graph
+    _image = GraphImage();
+    _arena.clear();
+    _arena.shrink_to_fit();
+    _keywordTrees.clear();
+    _tokenIndex = std::make_unique<LazyIndex<TokenIndex>>();
+    _matchCache.Clear();
+
+    // map file with answer graph elements into memory
+    bool isMapped = false;
+    {
+        ScopedTimer timer(MetricHistogram::LoadMapFile);
+        isMapped = _file.Open(filename);
+    }
+    if (!isMapped)
+    {
+        std::cout << "File could not be opened!" << std::endl;
+        return false;
+    }
+
+    // compiled graph images contain ready-made tables, only their bounds are checked
+    // (matching indexes are not part of the image, they are built on first use to keep opening in constant time)
+    if (GraphImage::IsGraphImage(_file.GetContent()))
+    {
+        bool isOpen = _image.Open(_file.GetContent());
+        reportProgress(1.0f);
+        return isOpen;
+    }
+
+    // tokenize all lines, large files are split into chunks which are parsed on worker threads
+    // (the shares of the loading stages below are rough estimates based on large text files)
+    GraphRecordTable records;
+    {
+        ScopedTimer timer(MetricHistogram::LoadTokenize);
+        ParseGraphRecords(_file.GetContent(), std::thread::hardware_concurrency(), records, [&reportProgress](float share) { reportProgress(0.5f * share); });
+    }
+    reportProgress(0.5f);
+
+    // resolve all records and lay out the tables in the arena
+    // all strings are copied into the string pool, so the file is no longer needed afterwards
+    GraphImageBuilder builder;
+    {
+        ScopedTimer timer(MetricHistogram::LoadLink);
+        builder.AddRecords(records);
+    }
+    reportProgress(0.8f);
+    bool isBuilt = builder.Build(_arena);
+    _file.Close();
+
+    bool isOpen = isBuilt && _image.Open(std::string_view(_arena.data(), _arena.size()));
+    if (isOpen)
+    {
+        // the tables have just been built and are hot anyway, so the first messages do not wait for an index
+        reportProgress(0.9f);
+        BuildKeywordTrees();
+        if (_matchingMode == MatchingMode::Tokens)
+            GetTokenIndex();
+    }
+    reportProgress(1.0f);
+    return isOpen;
+}
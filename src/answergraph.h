@@ -0,0 +1,124 @@
+#ifndef ANSWERGRAPH_H_
+#define ANSWERGRAPH_H_
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "mappedfile.h"
+#include "graphimage.h"
+#include "graphnode.h"
+#include "graphedge.h"
+#include "keywordindex.h"
+#include "keywordtree.h"
+#include "tokenindex.h"
+#include "matchcache.h"
+
+// called by AnswerGraph::LoadFromFile with the share of the loading work done so far (between 0 and 1)
+typedef std::function<void(float progress)> LoadProgressCallback;
+
+// how AnswerGraph::FindBestMatch compares a message with the keywords of a node
+enum class MatchingMode
+{
+    Message, // Levenshtein distance between the whole message and each keyword
+    Tokens   // keyword sharing the most words with the message (see TokenIndex), Message if no keyword shares a word
+};
+
+// nodes with at least this many keywords are matched through a KeywordTree instead of scoring every keyword
+// (trees are built while a text file is loaded, for compiled images when a node is matched for the first time)
+const size_t minKeywordTreeSize = 1024;
+
+// bytes used by a loaded graph (see AnswerGraph::GetMemoryUsage), e.g. for capacity planning
+struct GraphMemoryUsage
+{
+    size_t nodes;    // node table
+    size_t edges;    // edge table
+    size_t answers;  // answer table (references into the string pool)
+    size_t keywords; // keyword tables of edges and nodes (references into the string pool)
+    size_t strings;  // string pool with all distinct answers and keywords
+    size_t keywordTrees;
+    size_t tokenIndex;
+    size_t matchCache;
+    bool isMapped; // tables are used in place from a mapped image file, i.e. in the page cache instead of the heap
+
+    size_t GetTables() const { return nodes + edges + answers + keywords + strings; }
+    size_t GetIndexes() const { return keywordTrees + tokenIndex + matchCache; }
+    size_t GetTotal() const { return GetTables() + GetIndexes(); }
+};
+
+// answer graph with all nodes, edges and strings stored in a few contiguous tables
+// compiled images (see membotc) are used in place from the memory-mapped file,
+// text files are parsed and built into the same table layout inside a single arena
+// nodes and edges are never allocated one by one, so loading and releasing a graph takes a handful of allocations
+// matching indexes of text files are built while loading, so no message has to wait for them; for compiled images
+// they are built on first use instead, so opening an image takes constant time and does not touch its tables at all
+
+class AnswerGraph
+{
+private:
+    // proprietary type definitions
+    // index which is built by the first thread needing it, while other threads needing it wait for it
+    template <typename Index>
+    struct LazyIndex
+    {
+        std::once_flag isBuilding;
+        std::atomic<bool> isBuilt{false}; // only built indexes are included in GetMemoryUsage
+        Index index;
+    };
+
+    // data handles (owned)
+    MappedFile _file;         // mapped graph image
+    std::vector<char> _arena; // image built from a text file
+    GraphImage _image;        // tables inside _file or _arena
+    mutable std::unordered_map<uint32_t, std::unique_ptr<LazyIndex<KeywordTree>>> _keywordTrees; // node index -> tree, only for high-fanout nodes
+    mutable std::mutex _keywordTreeMutex;                                                        // protects _keywordTrees, not the trees
+    mutable std::unique_ptr<LazyIndex<TokenIndex>> _tokenIndex;                                  // only built in token matching mode
+    mutable MatchCache _matchCache; // results of FindBestMatch, internally synchronized
+
+    // proprietary members
+    MatchingMode _matchingMode;
+
+    // proprietary functions
+    KeywordIndex GetAllKeywords() const; // keywords of all nodes
+    const KeywordTree &GetKeywordTree(uint32_t nodeIndex) const;
+    void BuildKeywordTrees(); // of all nodes which are matched through a tree
+    const TokenIndex &GetTokenIndex() const;
+    KeywordMatch MatchKeywords(const GraphNode &node, std::string_view query) const;
+
+public:
+    // constructor / destructor
+    AnswerGraph() : _tokenIndex(std::make_unique<LazyIndex<TokenIndex>>()), _matchingMode(MatchingMode::Message) {}
+    AnswerGraph(const AnswerGraph &source) = delete; // _image refers into this object
+    AnswerGraph &operator=(const AnswerGraph &source) = delete;
+
+    // getter / setter
+    bool IsLoaded() const { return _image.IsOpen(); }
+    MatchingMode GetMatchingMode() const { return _matchingMode; }
+    void SetMatchingMode(MatchingMode mode); // not while the graph is in use, builds the token index of a loaded text file
+    const MatchCache &GetMatchCache() const { return _matchCache; }
+    void SetMatchCacheCapacity(size_t capacity) { _matchCache.SetCapacity(capacity); } // not while the graph is in use
+    size_t GetNumberOfNodes() const { return _image.GetHeader().numNodes; }
+    size_t GetNumberOfEdges() const { return _image.GetHeader().numEdges; }
+    const GraphNode *GetNodeAtIndex(size_t index) const { return _image.GetNodes() + index; }
+    const GraphNode *GetRootNode() const; // nullptr if the graph has no root node
+    std::string_view GetAnswer(const GraphNode &node, size_t index) const { return _image.GetString(_image.GetAnswers()[node.GetFirstAnswer() + index]); }
+    const GraphEdge *GetChildEdge(const GraphNode &node, size_t index) const { return _image.GetEdges() + node.GetFirstChildEdge() + index; }
+    const GraphNode *GetChildNode(const GraphEdge &edge) const { return _image.GetNodes() + edge.GetChildNode(); }
+    const GraphNode *GetParentNode(const GraphEdge &edge) const { return _image.GetNodes() + edge.GetParentNode(); }
+    std::string_view GetKeyword(const GraphEdge &edge, size_t index) const { return _image.GetString(_image.GetEdgeKeywords()[edge.GetFirstKeyword() + index]); }
+    KeywordIndex GetKeywordIndex(const GraphNode &node) const;
+    size_t GetNumberOfKeywordTrees() const; // trees built so far
+    GraphMemoryUsage GetMemoryUsage() const;
+
+    // proprietary functions
+    // closest child edge of node for a normalized query according to the matching mode
+    // results are cached per node and query, in Message mode the keyword tree of the node is used if there is one
+    KeywordMatch FindBestMatch(const GraphNode &node, std::string_view query) const;
+    bool LoadFromFile(const std::string &filename, const LoadProgressCallback &progressCallback = nullptr);
+};
+
+#endif /* ANSWERGRAPH_H_ */
@@ -1,30 +1,25 @@
 #ifndef CHATBOT_H_
 #define CHATBOT_H_
 
-#include <wx/bitmap.h>
 #include <string>
+#include "chatsession.h"
 
-class GraphNode; // forward declaration
 class ChatLogic; // forward declaration
 
+// conversation partner of the user on top of a ChatSession
+// the chatbot does not depend on any GUI toolkit, its avatar image is managed by the GUI (see ImageCache)
 class ChatBot
 {
 private:
-    // data handles (owned)
-    wxBitmap *_image; // avatar image
-
     // data handles (not owned)
-    GraphNode *_currentNode;
-    GraphNode *_rootNode;
     ChatLogic *_chatLogic;
 
-    // proprietary functions
-    int ComputeLevenshteinDistance(std::string s1, std::string s2);
+    // proprietary members
+    ChatSession _session; // position of the conversation in the answer graph
 
 public:
     // constructors / destructors
-    ChatBot();                                  // constructor WITHOUT memory allocation
-    ChatBot(std::string filename);              // constructor WITH memory allocation
+    ChatBot();                                  // constructor
     ~ChatBot();                                 // 1. destructor
     ChatBot(const ChatBot &source);             // 2. copy constructor
     ChatBot &operator=(const ChatBot &source);  // 3. copy assignment operator
@@ -32,14 +27,13 @@ public:
     ChatBot &operator=(ChatBot &&source);       // 5. move assignment operator
 
     // getters / setters
-    void SetCurrentNode(GraphNode *node);
-    void SetRootNode(GraphNode *rootNode) { _rootNode = rootNode; }
+    const ChatSession &GetSession() const { return _session; }
     void SetChatLogicHandle(ChatLogic *chatLogic) { _chatLogic = chatLogic; }
     ChatLogic* GetChatLogicHandle() { return _chatLogic; }
-    wxBitmap *GetImageHandle() { return _image; }
 
     // communication
-    void ReceiveMessageFromUser(std::string message);
+    void StartSession(const ChatSession &session, bool isGreeted = false); // greet the user with the answer of the root node (unless isGreeted)
+    void ReceiveMessageFromUser(const std::string &message);
 };
 
 #endif /* CHATBOT_H_ */
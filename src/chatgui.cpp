@@ -1,9 +1,12 @@
 #include <wx/filename.h>
 #include <wx/colour.h>
 #include <wx/image.h>
+#include <wx/dcbuffer.h>
+#include <wx/textwrapper.h>
 #include <string>
 #include <memory>
-#include "chatbot.h"
+#include <algorithm>
+#include "imagecache.h"
 #include "chatlogic.h"
 #include "chatgui.h"
 
@@ -11,6 +14,30 @@
 const int width = 414;
 const int height = 736;
 
+// layout of the dialog items
+const int dialogTextWidth = 150; // text is wrapped after this many pixels
+const int dialogItemMargin = 8;  // space around each item
+const int dialogItemBorder = 1;  // space between the item background and its content
+
+// wraps dialog text into lines, the lines are separated by '\n'
+class DialogTextWrapper : public wxTextWrapper
+{
+private:
+    wxString _text;
+
+protected:
+    virtual void OnOutputLine(const wxString &line) { _text += line; }
+    virtual void OnNewLine() { _text += '\n'; }
+
+public:
+    wxString WrapText(wxWindow *win, const wxString &text, int widthMax)
+    {
+        _text.clear();
+        Wrap(win, text, widthMax);
+        return _text;
+    }
+};
+
 // wxWidgets APP
 IMPLEMENT_APP(ChatBotApp);
 
@@ -19,6 +46,9 @@ std::string imgBasePath = dataPath + "images/";
 
 bool ChatBotApp::OnInit()
 {
+    // allow for PNG and JPEG images to be handled, this is needed before the first window loads its images
+    wxInitAllImageHandlers();
+
     // create window with name and show it
     ChatBotFrame *chatBotFrame = new ChatBotFrame(wxT("Udacity ChatBot"));
     chatBotFrame->Show(true);
@@ -29,6 +59,9 @@ bool ChatBotApp::OnInit()
 // wxWidgets FRAME
 ChatBotFrame::ChatBotFrame(const wxString &title) : wxFrame(NULL, wxID_ANY, title, wxDefaultPosition, wxSize(width, height))
 {
+    // status bar for loading progress, it has to exist before the dialog starts loading the answer graph
+    CreateStatusBar();
+
     // create panel with background image
     ChatBotFrameImagePanel *ctrlPanel = new ChatBotFrameImagePanel(this);
 
@@ -66,18 +99,56 @@ void ChatBotFrame::OnEnter(wxCommandEvent &WXUNUSED(event))
      _panelDialog->GetChatLogicHandle()->SendMessageToChatbot(std::string(userText.mb_str()));
 }
 
+ScaledBackground::ScaledBackground(const std::string &filename)
+{
+    _filename = filename;
+}
+
+const wxBitmap &ScaledBackground::GetBitmap(const wxSize &size)
+{
+    // decode image once
+    if (!_filename.empty())
+    {
+        _source = ImageCache::GetImage(_filename);
+        _filename.clear();
+    }
+
+    // rescale image to fit window dimensions if they have changed since the last call
+    // Scale leaves _source untouched, so repeated resizing does not accumulate quality losses
+    if (!_bitmap.IsOk() || size != _size)
+    {
+        _size = size;
+        _bitmap = _source.IsOk() ? wxBitmap(_source.Scale(size.GetWidth(), size.GetHeight(), wxIMAGE_QUALITY_HIGH)) : wxBitmap();
+    }
+
+    return _bitmap;
+}
+
 BEGIN_EVENT_TABLE(ChatBotFrameImagePanel, wxPanel)
 EVT_PAINT(ChatBotFrameImagePanel::paintEvent) // catch paint events
+EVT_SIZE(ChatBotFrameImagePanel::sizeEvent)   // catch resize events
 END_EVENT_TABLE()
 
-ChatBotFrameImagePanel::ChatBotFrameImagePanel(wxFrame *parent) : wxPanel(parent) {}
+ChatBotFrameImagePanel::ChatBotFrameImagePanel(wxFrame *parent) : wxPanel(parent), _background(imgBasePath + "sf_bridge.jpg")
+{
+    // the whole panel is painted in paintEvent, so the default background erase is not needed (required by wxAutoBufferedPaintDC)
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+}
 
 void ChatBotFrameImagePanel::paintEvent(wxPaintEvent &evt)
 {
-    wxPaintDC dc(this);
+    // draw into a back buffer first (if the platform does not double-buffer anyway) to avoid flicker
+    wxAutoBufferedPaintDC dc(this);
     render(dc);
 }
 
+void ChatBotFrameImagePanel::sizeEvent(wxSizeEvent &evt)
+{
+    // repaint the whole background with the new size, the sizer still needs the event
+    Refresh();
+    evt.Skip();
+}
+
 void ChatBotFrameImagePanel::paintNow()
 {
     wxClientDC dc(this);
@@ -86,62 +157,106 @@ void ChatBotFrameImagePanel::paintNow()
 
 void ChatBotFrameImagePanel::render(wxDC &dc)
 {
-    // load backgroud image from file
-    wxString imgFile = imgBasePath + "sf_bridge.jpg";
-    wxImage image;
-    image.LoadFile(imgFile);
-
-    // rescale image to fit window dimensions
-    wxSize sz = this->GetSize();
-    wxImage imgSmall = image.Rescale(sz.GetWidth(), sz.GetHeight(), wxIMAGE_QUALITY_HIGH);
-    _image = wxBitmap(imgSmall);
-    
-    dc.DrawBitmap(_image, 0, 0, false);
+    // background image is decoded once and only rescaled when the window size changes
+    const wxBitmap &image = _background.GetBitmap(this->GetSize());
+    if (image.IsOk())
+        dc.DrawBitmap(image, 0, 0, false);
 }
 
-BEGIN_EVENT_TABLE(ChatBotPanelDialog, wxPanel)
+BEGIN_EVENT_TABLE(ChatBotPanelDialog, wxVScrolledWindow)
 EVT_PAINT(ChatBotPanelDialog::paintEvent) // catch paint events
+EVT_SIZE(ChatBotPanelDialog::sizeEvent)   // catch resize events
 END_EVENT_TABLE()
 
 ChatBotPanelDialog::ChatBotPanelDialog(wxWindow *parent, wxWindowID id)
-    : wxScrolledWindow(parent, id)
+    : wxVScrolledWindow(parent, id), _background(imgBasePath + "sf_bridge_inner.jpg")
 {
-    // sizer will take care of determining the needed scroll size
-    _dialogSizer = new wxBoxSizer(wxVERTICAL);
-    this->SetSizer(_dialogSizer);
+    // the whole panel is painted in paintEvent (required by wxAutoBufferedPaintDC)
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
 
-    // allow for PNG images to be handled
-    wxInitAllImageHandlers();
+    // decode all GUI images on worker threads while the answer graph is loaded
+    ImageCache::Preload({imgBasePath + "sf_bridge.jpg", imgBasePath + "sf_bridge_inner.jpg", imgBasePath + "user.png", imgBasePath + "chatbot.png"});
 
     // create chat logic instance 
     _chatLogic = std::make_unique<ChatLogic>();
 
-    // pass pointer to chatbot dialog so answers can be displayed in GUI
-    _chatLogic->SetPanelDialogHandle(this);
+    // let answers and loading progress be displayed in GUI
+    // chatlogic may call back from its worker thread, so the calls are forwarded to the GUI thread
+    _chatLogic->SetResponseCallback([this](const std::string &response) { CallAfter(&ChatBotPanelDialog::PrintChatbotResponse, response); });
+    _chatLogic->SetProgressCallback([this](float progress) { CallAfter(&ChatBotPanelDialog::ShowLoadingProgress, progress); });
+
+    // load answer graph from file in the background, so the window shows up immediately
+    // user messages are matched on the same worker thread, so large graphs do not block input and painting either
+    _chatLogic->LoadAnswerGraphFromFileAsync(dataPath + "src/answergraph.txt");
 
-    // load answer graph from file
-    _chatLogic->LoadAnswerGraphFromFile(dataPath + "src/answergraph.txt");
+    // the avatars are the same for all messages, so they are decoded only once
+    _userImage = ImageCache::GetBitmap(imgBasePath + "user.png", wxBITMAP_TYPE_PNG);
+    _chatBotImage = ImageCache::GetBitmap(imgBasePath + "chatbot.png", wxBITMAP_TYPE_PNG);
 }
 
 ChatBotPanelDialog::~ChatBotPanelDialog() {}
 
+const wxBitmap *ChatBotPanelDialog::GetItemImage(const DialogItem &item) const
+{
+    const wxBitmap *image = item.isFromUser ? _userImage.get() : _chatBotImage.get();
+    return image != nullptr && image->IsOk() ? image : nullptr;
+}
+
+wxCoord ChatBotPanelDialog::OnGetRowHeight(size_t row) const
+{
+    return _items[row].height;
+}
+
+bool ChatBotPanelDialog::DoScrollToUnit(size_t unit)
+{
+    if (!wxVScrolledWindow::DoScrollToUnit(unit))
+        return false;
+
+    // the base class moves the pixels on screen by ScrollWindow, which would take the background along with the rows
+    RefreshAll();
+    return true;
+}
+
 void ChatBotPanelDialog::AddDialogItem(wxString text, bool isFromUser)
 {
-    // add a single dialog element to the sizer
-    ChatBotPanelDialogItem *item = new ChatBotPanelDialogItem(this, text, isFromUser);
-    _dialogSizer->Add(item, 0, wxALL | (isFromUser == true ? wxALIGN_LEFT : wxALIGN_RIGHT), 8);
-    _dialogSizer->Layout();
+    // wrap text after dialogTextWidth pixels and measure it once
+    DialogItem item;
+    item.isFromUser = isFromUser;
+
+    wxClientDC dc(this);
+    dc.SetFont(GetFont());
+    DialogTextWrapper wrapper;
+    item.text = wrapper.WrapText(this, text, dialogTextWidth);
 
-    // make scrollbar show up
-    this->FitInside(); // ask the sizer about the needed size
-    this->SetScrollRate(5, 5);
-    this->Layout();
+    wxCoord textWidth, textHeight;
+    dc.GetMultiLineTextExtent(item.text, &textWidth, &textHeight);
+    const wxBitmap *image = GetItemImage(item);
+    wxCoord contentHeight = std::max(textHeight, image != nullptr ? image->GetHeight() : 0);
+    item.height = contentHeight + 2 * (dialogItemMargin + dialogItemBorder);
+
+    // append the message to the model, only the rows on screen are painted again
+    _items.push_back(item);
+    SetRowCount(_items.size());
 
     // scroll to bottom to show newest element
-    int dx, dy;
-    this->GetScrollPixelsPerUnit(&dx, &dy);
-    int sy = dy * this->GetScrollLines(wxVERTICAL);
-    this->DoScroll(0, sy);
+    ScrollToLastItem();
+    Refresh();
+}
+
+void ChatBotPanelDialog::ScrollToLastItem()
+{
+    // find the first row from which all remaining rows fit into the window,
+    // only the rows which end up on screen are visited
+    wxCoord available = GetClientSize().GetHeight();
+    size_t firstRow = _items.size();
+    while (firstRow > 0 && _items[firstRow - 1].height <= available)
+    {
+        available -= _items[firstRow - 1].height;
+        --firstRow;
+    }
+
+    // the last row is shown in any case, even if it is larger than the window
+    ScrollToRow(std::min(firstRow, _items.size() - 1));
 }
 
 void ChatBotPanelDialog::PrintChatbotResponse(std::string response)
@@ -151,12 +266,31 @@ void ChatBotPanelDialog::PrintChatbotResponse(std::string response)
     AddDialogItem(botText, false);
 }
 
+void ChatBotPanelDialog::ShowLoadingProgress(float progress)
+{
+    // show progress in the status bar of the frame
+    wxFrame *frame = wxDynamicCast(wxGetTopLevelParent(this), wxFrame);
+    if (frame == nullptr || frame->GetStatusBar() == nullptr)
+        return;
+
+    if (progress < 1.0f)
+        frame->SetStatusText(wxString::Format(wxT("Loading answer graph ... %d%%"), static_cast<int>(progress * 100)));
+    else
+        frame->SetStatusText(wxT("Answer graph loaded"));
+}
+
 void ChatBotPanelDialog::paintEvent(wxPaintEvent &evt)
 {
-    wxPaintDC dc(this);
+    wxAutoBufferedPaintDC dc(this);
     render(dc);
 }
 
+void ChatBotPanelDialog::sizeEvent(wxSizeEvent &evt)
+{
+    Refresh();
+    evt.Skip();
+}
+
 void ChatBotPanelDialog::paintNow()
 {
     wxClientDC dc(this);
@@ -165,36 +299,36 @@ void ChatBotPanelDialog::paintNow()
 
 void ChatBotPanelDialog::render(wxDC &dc)
 {
-    wxImage image;
-    image.LoadFile(imgBasePath + "sf_bridge_inner.jpg");
-
-    wxSize sz = this->GetSize();
-    wxImage imgSmall = image.Rescale(sz.GetWidth(), sz.GetHeight(), wxIMAGE_QUALITY_HIGH);
-
-    _image = wxBitmap(imgSmall);
-    dc.DrawBitmap(_image, 0, 0, false);
-}
-
-ChatBotPanelDialogItem::ChatBotPanelDialogItem(wxPanel *parent, wxString text, bool isFromUser)
-    : wxPanel(parent, -1, wxPoint(-1, -1), wxSize(-1, -1), wxBORDER_NONE)
-{
-    // retrieve image from chatbot
-    wxBitmap *bitmap = isFromUser == true ? nullptr : ((ChatBotPanelDialog*)parent)->GetChatLogicHandle()->GetImageFromChatbot(); 
-
-    // create image and text
-    _chatBotImg = new wxStaticBitmap(this, wxID_ANY, (isFromUser ? wxBitmap(imgBasePath + "user.png", wxBITMAP_TYPE_PNG) : *bitmap), wxPoint(-1, -1), wxSize(-1, -1));
-    _chatBotTxt = new wxStaticText(this, wxID_ANY, text, wxPoint(-1, -1), wxSize(150, -1), wxALIGN_CENTRE | wxBORDER_NONE);
-    _chatBotTxt->SetForegroundColour(isFromUser == true ? wxColor(*wxBLACK) : wxColor(*wxWHITE));
-
-    // create sizer and add elements
-    wxBoxSizer *horzBoxSizer = new wxBoxSizer(wxHORIZONTAL);
-    horzBoxSizer->Add(_chatBotTxt, 8, wxEXPAND | wxALL, 1);
-    horzBoxSizer->Add(_chatBotImg, 2, wxEXPAND | wxALL, 1);
-    this->SetSizer(horzBoxSizer);
-
-    // wrap text after 150 pixels
-    _chatBotTxt->Wrap(150);
-
-    // set background color
-    this->SetBackgroundColour((isFromUser == true ? wxT("YELLOW") : wxT("BLUE")));
+    const wxBitmap &background = _background.GetBitmap(this->GetSize());
+    if (background.IsOk())
+        dc.DrawBitmap(background, 0, 0, false);
+
+    dc.SetFont(GetFont());
+    dc.SetPen(*wxTRANSPARENT_PEN);
+
+    // draw visible rows only, user messages are aligned left and chatbot messages right
+    wxCoord y = 0;
+    wxCoord windowWidth = GetClientSize().GetWidth();
+    for (size_t row = GetVisibleRowsBegin(); row < GetVisibleRowsEnd() && row < _items.size(); ++row)
+    {
+        const DialogItem &item = _items[row];
+        const wxBitmap *image = GetItemImage(item);
+        wxCoord imageWidth = image != nullptr ? image->GetWidth() : 0;
+
+        // item background
+        wxCoord itemWidth = dialogTextWidth + imageWidth + 4 * dialogItemBorder;
+        wxCoord itemHeight = item.height - 2 * dialogItemMargin;
+        wxCoord x = item.isFromUser ? dialogItemMargin : windowWidth - itemWidth - dialogItemMargin;
+        dc.SetBrush(wxBrush(item.isFromUser ? wxColour(*wxYELLOW) : wxColour(*wxBLUE)));
+        dc.DrawRectangle(x, y + dialogItemMargin, itemWidth, itemHeight);
+
+        // text and image side by side
+        wxRect textRect(x + dialogItemBorder, y + dialogItemMargin + dialogItemBorder, dialogTextWidth, itemHeight - 2 * dialogItemBorder);
+        dc.SetTextForeground(item.isFromUser ? wxColour(*wxBLACK) : wxColour(*wxWHITE));
+        dc.DrawLabel(item.text, textRect, wxALIGN_CENTRE);
+        if (image != nullptr)
+            dc.DrawBitmap(*image, textRect.GetRight() + 1 + 2 * dialogItemBorder, y + dialogItemMargin + (itemHeight - image->GetHeight()) / 2, true);
+
+        y += item.height;
+    }
 }
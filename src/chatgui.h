@@ -2,21 +2,68 @@
 #define CHATGUI_H_
 
 #include <wx/wx.h>
+#include <wx/image.h>
+#include <wx/vscroll.h>
+#include <string>
+#include <vector>
 #include <memory>
 
 class ChatLogic; // forward declaration
 
+// background image which is decoded once and rescaled only when the size of its window changes
+// the image is requested from ImageCache on first use, so it can be decoded in the background until the first paint
+class ScaledBackground
+{
+private:
+    // control elements
+    std::string _filename;
+    wxImage _source;  // decoded image in original size
+    wxBitmap _bitmap; // _source rescaled to _size
+    wxSize _size;
+
+public:
+    // constructor / destructor
+    ScaledBackground(const std::string &filename);
+
+    // getter / setter
+    const wxBitmap &GetBitmap(const wxSize &size);
+};
+
+// message shown in ChatBotPanelDialog
+// the text is wrapped and measured once when the message is added, so painting does not have to lay it out again
+struct DialogItem
+{
+    wxString text; // wrapped into lines
+    wxCoord height; // height of the complete row including margins
+    bool isFromUser;
+};
+
 // middle part of the window containing the dialog between user and chatbot
-class ChatBotPanelDialog : public wxScrolledWindow
+// the dialog is a virtual list: only the rows which are currently visible are drawn,
+// so adding a message and scrolling take the same time no matter how long the dialog is
+class ChatBotPanelDialog : public wxVScrolledWindow
 {
 private:
     // control elements
-    wxBoxSizer *_dialogSizer;
-    wxBitmap _image;
+    std::vector<DialogItem> _items;
+    ScaledBackground _background;
+    std::shared_ptr<const wxBitmap> _userImage;
+    std::shared_ptr<const wxBitmap> _chatBotImage;
 
     // ChatBotPanelDialog holds exclusive ownership ower _chatLogic
     std::unique_ptr<ChatLogic> _chatLogic;
 
+    // proprietary functions
+    const wxBitmap *GetItemImage(const DialogItem &item) const;
+    void ScrollToLastItem();
+
+protected:
+    // row heights for wxVScrolledWindow
+    virtual wxCoord OnGetRowHeight(size_t row) const;
+
+    // scrolling (by ScrollToRow as well as by the scroll bar) repaints the whole window, as the background stays in place
+    virtual bool DoScrollToUnit(size_t unit);
+
 public:
     // constructor / destructor
     ChatBotPanelDialog(wxWindow *parent, wxWindowID id);
@@ -28,29 +75,18 @@ public:
 
     // events
     void paintEvent(wxPaintEvent &evt);
+    void sizeEvent(wxSizeEvent &evt);
     void paintNow();
     void render(wxDC &dc);
 
     // proprietary functions
     void AddDialogItem(wxString text, bool isFromUser = true);
     void PrintChatbotResponse(std::string response);
+    void ShowLoadingProgress(float progress);
 
     DECLARE_EVENT_TABLE()
 };
 
-// dialog item shown in ChatBotPanelDialog
-class ChatBotPanelDialogItem : public wxPanel
-{
-private:
-    // control elements
-    wxStaticBitmap *_chatBotImg;
-    wxStaticText *_chatBotTxt;
-
-public:
-    // constructor / destructor
-    ChatBotPanelDialogItem(wxPanel *parent, wxString text, bool isFromUser);
-};
-
 // frame containing all control elements
 class ChatBotFrame : public wxFrame
 {
@@ -71,7 +107,7 @@ public:
 class ChatBotFrameImagePanel : public wxPanel
 {
     // control elements
-    wxBitmap _image;
+    ScaledBackground _background;
 
 public:
     // constructor / desctructor
@@ -79,6 +115,7 @@ public:
 
     // events
     void paintEvent(wxPaintEvent &evt);
+    void sizeEvent(wxSizeEvent &evt);
     void paintNow();
     void render(wxDC &dc);
 
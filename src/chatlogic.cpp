@@ -1,217 +1,241 @@
-#include <fstream>
-#include <sstream>
 #include <iostream>
-#include <vector>
-#include <iterator>
-#include <tuple>
-#include <algorithm>
-#include <memory>
-#include "graphedge.h"
-#include "graphnode.h"
+#include <random>
+#include "graphparser.h"
+#include "metrics.h"
 #include "chatbot.h"
 #include "chatlogic.h"
 
-ChatLogic::ChatLogic() {}
+ChatLogic::ChatLogic() : _publisher(std::make_shared<GraphPublisher>())
+{
+    _isStopping = false;
+    _matchingMode = MatchingMode::Message;
+}
 
-ChatLogic::~ChatLogic() {}
+ChatLogic::~ChatLogic()
+{
+    // neither the reloader nor the worker must outlive the chatbot and graph they are working on
+    WaitForReload();
+    StopWorker();
+}
 
-template <typename T>
-void ChatLogic::AddAllTokensToElement(std::string tokenID, tokenlist &tokens, T &element)
+void ChatLogic::StartWorker()
 {
-    // find all occurences for current node
-    auto token = tokens.begin();
-    while (true)
+    if (_worker.joinable())
+        return;
+
+    _isStopping = false;
+    _worker = std::thread(&ChatLogic::ProcessTasks, this);
+}
+
+void ChatLogic::StopWorker()
+{
+    if (!_worker.joinable())
+        return;
+
     {
-        token = std::find_if(token, tokens.end(), [&tokenID](const std::pair<std::string, std::string> &pair) { return pair.first == tokenID;; });
-        if (token != tokens.end())
-        {
-            element.AddToken(token->second); // add new keyword to edge
-            token++;                         // increment iterator to next element
-        }
-        else
-        {
-            break; // quit infinite while-loop
-        }
+        std::lock_guard<std::mutex> lock(_taskMutex);
+        _isStopping = true;
+        _tasks.clear();
     }
+    _taskCondition.notify_one();
+    _worker.join();
 }
 
-void ChatLogic::LoadAnswerGraphFromFile(std::string filename)
+bool ChatLogic::StartSessionScheduler(unsigned int numThreads, SessionResponseCallback callback)
 {
-    // load file with answer graph elements
-    std::ifstream file(filename);
+    if (_publisher->GetGraph() == nullptr)
+        return false;
+
+    std::unique_ptr<SessionScheduler> scheduler = std::make_unique<SessionScheduler>(_publisher, numThreads, std::move(callback));
+    std::lock_guard<std::mutex> lock(_schedulerMutex);
+    _scheduler.swap(scheduler);
+    return true; // a previous scheduler is stopped once the lock has been released
+}
 
-    // check for file availability and process it line by line
-    if (file)
+void ChatLogic::StopSessionScheduler()
+{
+    std::unique_ptr<SessionScheduler> scheduler;
     {
-        // loop over all lines in the file
-        std::string lineStr;
-        while (getline(file, lineStr))
-        {
-            // extract all tokens from current line
-            tokenlist tokens;
-            while (lineStr.size() > 0)
-            {
-                // extract next token
-                int posTokenFront = lineStr.find("<");
-                int posTokenBack = lineStr.find(">");
-                if (posTokenFront < 0 || posTokenBack < 0)
-                    break; // quit loop if no complete token has been found
-                std::string tokenStr = lineStr.substr(posTokenFront + 1, posTokenBack - 1);
-
-                // extract token type and info
-                int posTokenInfo = tokenStr.find(":");
-                if (posTokenInfo != std::string::npos)
-                {
-                    std::string tokenType = tokenStr.substr(0, posTokenInfo);
-                    std::string tokenInfo = tokenStr.substr(posTokenInfo + 1, tokenStr.size() - 1);
-
-                    // add token to vector
-                    tokens.push_back(std::make_pair(tokenType, tokenInfo));
-                }
-
-                // remove token from current line
-                lineStr = lineStr.substr(posTokenBack + 1, lineStr.size());
-            }
-
-            // process tokens for current line
-            auto type = std::find_if(tokens.begin(), tokens.end(), [](const std::pair<std::string, std::string> &pair) { return pair.first == "TYPE"; });
-            if (type != tokens.end())
-            {
-                // check for id
-                auto idToken = std::find_if(tokens.begin(), tokens.end(), [](const std::pair<std::string, std::string> &pair) { return pair.first == "ID"; });
-                if (idToken != tokens.end())
-                {
-                    // extract id from token
-                    int id = std::stoi(idToken->second);
-
-                    // node-based processing
-                    if (type->second == "NODE")
-                    {
-                        // check if node with this ID exists already
-                        // find_if returns an iterator to the first element in the range _nodes.begin() to _nodes.end() for which the lambda function returns true
-                        // the smart pointers inside _nodes need to be passed to the lambda function by reference because ownership of the managed GraphNode should not be transferred
-                        // use const to ensure the lambda function does not modify _nodes
-                        auto newNode = std::find_if(_nodes.begin(), _nodes.end(), [&id](const auto &node) { return node->GetID() == id; });
-
-                        // create new element if ID does not yet exist
-                        if (newNode == _nodes.end())
-                        {
-                            _nodes.emplace_back(std::make_unique<GraphNode>(id)); // create new smart pointer
-                            newNode = _nodes.end() - 1; // get iterator to last element
-
-                            // add all answers to current node
-                            AddAllTokensToElement("ANSWER", tokens, **newNode); // newNode is an iterator (=a pointer) to a unique_ptr<GraphNode> instance. 
-                                                                                // I can get a pointer to the underlying unique_ptr<GraphNode> by using the dereferencing operator *.
-                                                                                // I then can get to the managed object by using the dereferencing operator again (just like if unique_ptr were in fact a raw pointer).
-                                                                                // This works because smart pointers overwrite the dereferencing operator to behave exactly like "normal" (raw) pointers in such cases
-                        }
-                    }
-
-                    // edge-based processing
-                    if (type->second == "EDGE")
-                    {
-                        // find tokens for incoming (parent) and outgoing (child) node
-                        auto parentToken = std::find_if(tokens.begin(), tokens.end(), [](const std::pair<std::string, std::string> &pair) { return pair.first == "PARENT"; });
-                        auto childToken = std::find_if(tokens.begin(), tokens.end(), [](const std::pair<std::string, std::string> &pair) { return pair.first == "CHILD"; });
-
-                        if (parentToken != tokens.end() && childToken != tokens.end())
-                        {
-                            // get iterator on incoming and outgoing node via ID search
-                            // find_if returns an iterator to the first element in the range _nodes.begin() to _nodes.end() for which the lambda function returns true
-                            // the smart pointers inside _nodes need to be passed to the lambda function by reference because ownership of the managed GraphNode should not be transferred
-                            // use const to ensure the lambda function does not modify _nodes
-                            auto parentNode = std::find_if(_nodes.begin(), _nodes.end(), [&parentToken](const auto &node) { return node->GetID() == std::stoi(parentToken->second); });
-                            auto childNode = std::find_if(_nodes.begin(), _nodes.end(), [&childToken](const auto &node) { return node->GetID() == std::stoi(childToken->second); });
-
-                            // create new edge as unique_ptr
-                            std::unique_ptr<GraphEdge> edge = std::make_unique<GraphEdge>(id);
-                            edge->SetChildNode((*childNode).get()); // childNode is an iterator to a unique_ptr<GraphNode> instance
-                                                                    // I can get a pointer to the underlying unique_ptr<GraphNode> by using the dereferencing operator *
-                            edge->SetParentNode((*parentNode).get());
-
-                            // find all keywords for current node
-                            AddAllTokensToElement("KEYWORD", tokens, *edge);
-
-                            // store reference in child node and parent node
-                            (*childNode)->AddEdgeToParentNode(edge.get());
-                            (*parentNode)->AddEdgeToChildNode(std::move(edge));
-                        }
-                    }
-                }
-                else
-                {
-                    std::cout << "Error: ID missing. Line is ignored!" << std::endl;
-                }
-            }
-        } // eof loop over all lines in the file
-
-        file.close();
-
-    } // eof check for file availability
-    else
+        std::lock_guard<std::mutex> lock(_schedulerMutex);
+        _scheduler.swap(scheduler);
+    }
+}
+
+void ChatLogic::SendMessageToSession(const std::string &sessionId, std::string message)
+{
+    if (_scheduler != nullptr)
+        _scheduler->PostMessage(sessionId, std::move(message));
+}
+
+void ChatLogic::CloseSession(const std::string &sessionId)
+{
+    if (_scheduler != nullptr)
+        _scheduler->CloseSession(sessionId);
+}
+
+size_t ChatLogic::CloseIdleSessions(std::chrono::steady_clock::duration maxIdleTime)
+{
+    return _scheduler != nullptr ? _scheduler->CloseIdleSessions(maxIdleTime) : 0;
+}
+
+void ChatLogic::WaitForSessions()
+{
+    if (_scheduler != nullptr)
+        _scheduler->WaitUntilIdle();
+}
+
+void ChatLogic::PostTask(std::function<void()> task)
+{
     {
-        std::cout << "File could not be opened!" << std::endl;
-        return;
+        std::lock_guard<std::mutex> lock(_taskMutex);
+        _tasks.push_back(std::move(task));
     }
+    _taskCondition.notify_one();
+}
 
-    // identify root node
-    GraphNode *rootNode = nullptr;
-    for (auto it = std::begin(_nodes); it != std::end(_nodes); ++it)
+void ChatLogic::ProcessTasks()
+{
+    std::unique_lock<std::mutex> lock(_taskMutex);
+    while (true)
     {
-        // search for nodes which have no incoming edges
-        if ((*it)->GetNumberOfParents() == 0) // I can get to the unique_ptr with *
-                                              // as with a "normal" raw pointer, I can use -> to access member variables
-                                              // (*it).get()->GetNumberOfParents() would be equivalent
-        {
+        _taskCondition.wait(lock, [this]() { return _isStopping || !_tasks.empty(); });
+        if (_isStopping)
+            return;
+
+        std::function<void()> task = std::move(_tasks.front());
+        _tasks.pop_front();
+
+        // run the task without holding the lock, so new messages can be posted in the meantime
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+void ChatLogic::CreateChatbot()
+{
+    if (_chatBot != nullptr)
+        return;
+
+    // create the ChatBot, which is owned by chatlogic and refers to graph nodes without owning them
+    _chatBot = std::make_unique<ChatBot>();
+
+    // make sure the chatbot holds a pointer to this chatLogic to be able to send messages
+    _chatBot->SetChatLogicHandle(this);
+}
+
+void ChatLogic::LoadAnswerGraphFromFile(std::string filename)
+{
+    // the caller waits for the complete graph anyway, so there is nothing to gain from an early welcome
+    CreateChatbot();
+    LoadAnswerGraph(filename, false);
+}
 
-            if (rootNode == nullptr)
-            {
-                rootNode = (*it).get(); // assign current node to root
-            }
-            else
-            {
-                std::cout << "ERROR : Multiple root nodes detected" << std::endl;
-            }
+void ChatLogic::LoadAnswerGraphFromFileAsync(std::string filename)
+{
+    CreateChatbot();
+    StartWorker();
+
+    // messages sent while the graph is loading are queued behind this task
+    PostTask([this, filename]() { LoadAnswerGraph(filename, _responseCallback != nullptr); });
+}
+
+void ChatLogic::LoadAnswerGraph(const std::string &filename, bool isGreetingEarly)
+{
+    // greet the user with an answer of node 0 (the root node of regular answer graphs) as soon as its line is read,
+    // instead of waiting for the complete graph (compiled images are opened instantly, so they are not scanned)
+    bool isGreeted = false;
+    if (isGreetingEarly)
+    {
+        MappedFile file;
+        GraphRecord record;
+        if (file.Open(filename) && !GraphImage::IsGraphImage(file.GetContent()) && FindGraphNodeRecord(file.GetContent(), 0, record) && !record.answers.empty())
+        {
+            Pcg32 generator(std::random_device{}());
+            std::uniform_int_distribution<size_t> dis(0, record.answers.size() - 1);
+            SendMessageToUser(std::string(record.answers[dis(generator)]));
+            isGreeted = true;
         }
     }
 
-    // create local instance of ChatBot on the stack
-    ChatBot myBot = ChatBot("../images/chatbot.png");
+    std::shared_ptr<const AnswerGraph> graph = BuildAnswerGraph(filename);
+    if (graph == nullptr)
+        return;
+    _publisher->Publish(graph);
+
+    // start the conversation at the graph root node, the welcome answer is only sent if it has not been sent yet
+    _chatBot->StartSession(CreateSession(), isGreeted && graph->GetRootNode()->GetID() == 0);
+}
 
-    // make sure chatlogic class has a reference to the ChatBot to send/receive messages
-    _chatBot = &myBot; 
+std::shared_ptr<const AnswerGraph> ChatLogic::BuildAnswerGraph(const std::string &filename)
+{
+    // load all nodes, edges and strings into the contiguous tables of the graph
+    std::shared_ptr<AnswerGraph> graph = std::make_shared<AnswerGraph>();
+    graph->SetMatchingMode(_matchingMode);
+    if (!graph->LoadFromFile(filename, [this](float progress) { SendProgressToUser(progress); }))
+        return nullptr;
 
-    // make sure myBot holds a pointer to this chatLogic to be able to send messages 
-    myBot.SetChatLogicHandle(this);
+    if (graph->GetRootNode() == nullptr)
+    {
+        std::cout << "ERROR : No root node detected" << std::endl;
+        return nullptr;
+    }
 
-    // add myBot to graph root node
-    myBot.SetRootNode(rootNode);
+    return graph;
+}
 
-    // move myBot to rootNode
-    rootNode->MoveChatbotHere(std::move(myBot));
+void ChatLogic::ReloadAnswerGraphFromFileAsync(std::string filename)
+{
+    // reloads are done one after the other, the last one published wins
+    WaitForReload();
+    _reloader = std::thread([this, filename]() {
+        std::shared_ptr<const AnswerGraph> graph = BuildAnswerGraph(filename);
+        if (graph == nullptr)
+            return;
+        _publisher->Publish(std::move(graph));
+
+        // sessions waiting at the root node would keep the previous graph alive until their next message
+        std::lock_guard<std::mutex> lock(_schedulerMutex);
+        if (_scheduler != nullptr)
+            _scheduler->MoveIdleSessionsToPublishedGraph();
+    });
 }
 
-void ChatLogic::SetPanelDialogHandle(ChatBotPanelDialog *panelDialog)
+void ChatLogic::WaitForReload()
 {
-    _panelDialog = panelDialog;
+    if (_reloader.joinable())
+        _reloader.join();
 }
 
-void ChatLogic::SetChatbotHandle(ChatBot *chatbot)
+ChatSession ChatLogic::CreateSession() const
 {
-    _chatBot = chatbot;
+    // every session gets its own random generator, so sessions never contend for shared state
+    return ChatSession(_publisher, std::random_device{}());
 }
 
-void ChatLogic::SendMessageToChatbot(std::string message)
+void ChatLogic::SendMessageToChatbot(const std::string &message)
 {
-    _chatBot->ReceiveMessageFromUser(message);
+    if (_chatBot == nullptr)
+        return;
+
+    // the chatbot (and its session) is only ever used by one thread at a time: the worker in asynchronous mode,
+    // the calling thread otherwise
+    if (IsAsynchronous())
+        PostTask([this, message]() { _chatBot->ReceiveMessageFromUser(message); });
+    else
+        _chatBot->ReceiveMessageFromUser(message);
 }
 
 void ChatLogic::SendMessageToUser(std::string message)
 {
-    _panelDialog->PrintChatbotResponse(message);
+    ScopedTimer timer(MetricHistogram::SendMessage);
+    AddToCounter(MetricCounter::MessagesSent);
+    if (_responseCallback)
+        _responseCallback(message);
 }
 
-wxBitmap *ChatLogic::GetImageFromChatbot()
+void ChatLogic::SendProgressToUser(float progress)
 {
-    return _chatBot->GetImageHandle();
+    if (_progressCallback)
+        _progressCallback(progress);
 }
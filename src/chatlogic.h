@@ -1,32 +1,61 @@
 #ifndef CHATLOGIC_H_
 #define CHATLOGIC_H_
 
-#include <vector>
+#include <memory>
 #include <string>
-#include "chatgui.h"
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "answergraph.h"
+#include "chatsession.h"
+#include "graphpublisher.h"
+#include "sessionscheduler.h"
 
 // forward declarations
 class ChatBot;
-class GraphEdge;
-class GraphNode;
 
+// called with every answer of the chatbot
+typedef std::function<void(const std::string &response)> ResponseCallback;
+
+// connects a front-end (e.g. the wxWidgets GUI) with the chatbot, without depending on the front-end itself
+// responses and loading progress are handed to callbacks which may be invoked on the worker thread in asynchronous mode,
+// a GUI therefore has to forward them to its main thread
 class ChatLogic
 {
 private:
     // data handles (owned)
-    std::vector<std::unique_ptr<GraphNode>> _nodes;
+    std::shared_ptr<GraphPublisher> _publisher; // current graph, shared with all sessions and immutable once loaded
+    std::unique_ptr<ChatBot> _chatBot;
+    std::unique_ptr<SessionScheduler> _scheduler; // multi-session mode
+
+    // front-end callbacks
+    ResponseCallback _responseCallback;
+    LoadProgressCallback _progressCallback;
+
+    // worker thread for asynchronous mode, tasks are processed one after the other in the order they were posted
+    std::thread _worker;
+    std::mutex _taskMutex;
+    std::condition_variable _taskCondition;
+    std::deque<std::function<void()>> _tasks;
+    bool _isStopping;
 
-    // data handles (not owned)
-    GraphNode *_currentNode;
-    ChatBot *_chatBot; // no change necessary here to make this non-owning
-    ChatBotPanelDialog *_panelDialog;
+    // background thread which builds a replacement graph (see ReloadAnswerGraphFromFileAsync)
+    // the scheduler is only replaced while holding the mutex, as the reloader moves its idle sessions to the new graph
+    std::thread _reloader;
+    std::mutex _schedulerMutex;
 
-    // proprietary type definitions
-    typedef std::vector<std::pair<std::string, std::string>> tokenlist;
+    // proprietary members
+    MatchingMode _matchingMode;
 
     // proprietary functions
-    template <typename T>
-    void AddAllTokensToElement(std::string tokenID, tokenlist &tokens, T &element);
+    void PostTask(std::function<void()> task);
+    void ProcessTasks();
+    void CreateChatbot();
+    std::shared_ptr<const AnswerGraph> BuildAnswerGraph(const std::string &filename); // nullptr on errors
+    void LoadAnswerGraph(const std::string &filename, bool isGreetingEarly); // isGreetingEarly: welcome before the graph is built
 
 public:
     // constructor / destructor
@@ -34,14 +63,42 @@ public:
     ~ChatLogic();
 
     // getter / setter
-    void SetPanelDialogHandle(ChatBotPanelDialog *panelDialog);
-    void SetChatbotHandle(ChatBot *chatbot);
+    void SetResponseCallback(ResponseCallback callback) { _responseCallback = std::move(callback); }
+    void SetProgressCallback(LoadProgressCallback callback) { _progressCallback = std::move(callback); }
+    void SetMatchingMode(MatchingMode mode) { _matchingMode = mode; } // takes effect with the next graph loaded
+    std::shared_ptr<const AnswerGraph> GetAnswerGraph() const { return _publisher->GetGraph(); }
+
+    // asynchronous mode
+    // once the worker has been started, messages to the chatbot are queued and matched on the worker thread
+    // there is one queue for all messages, so responses arrive in the order the messages were sent
+    void StartWorker();
+    void StopWorker(); // pending messages are discarded
+    bool IsAsynchronous() const { return _worker.joinable(); }
+
+    // multi-session mode
+    // messages of any number of sessions, identified by their ID, are answered on a pool of worker threads
+    // (see SessionScheduler), independently of the chatbot; the graph has to be loaded before the scheduler is started
+    bool StartSessionScheduler(unsigned int numThreads, SessionResponseCallback callback);
+    void StopSessionScheduler(); // pending messages are discarded, only the messages being answered are finished
+    void SendMessageToSession(const std::string &sessionId, std::string message);
+    void CloseSession(const std::string &sessionId); // discards the pending messages of the session
+    size_t CloseIdleSessions(std::chrono::steady_clock::duration maxIdleTime); // see SessionScheduler::CloseIdleSessions
+    void WaitForSessions(); // blocks until all messages sent to sessions so far have been answered
 
     // proprietary functions
     void LoadAnswerGraphFromFile(std::string filename);
-    void SendMessageToChatbot(std::string message);
+    void LoadAnswerGraphFromFileAsync(std::string filename); // starts the worker, messages are queued until the graph is loaded
+
+    // hot reload: builds a new graph on a background thread while all sessions keep answering from the current one
+    // once it is complete, the new graph is published and every session switches over the next time it returns to the root
+    // node (the chatbot as well as the sessions of the scheduler); the current graph stays in place if loading fails
+    // scheduler sessions which are waiting at the root node are moved to the new graph as soon as it has been published
+    void ReloadAnswerGraphFromFileAsync(std::string filename);
+    void WaitForReload(); // blocks until a reload in progress has been completed
+    ChatSession CreateSession() const; // new conversation on the loaded graph, may be used independently of the chatbot
+    void SendMessageToChatbot(const std::string &message);
     void SendMessageToUser(std::string message);
-    wxBitmap *GetImageFromChatbot();
+    void SendProgressToUser(float progress);
 };
 
 #endif /* CHATLOGIC_H_ */
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "chatserver.h"
+
+ChatServer::ChatServer(std::shared_ptr<const GraphPublisher> publisher, unsigned int numThreads)
+    : _batchResponses(nullptr), _scheduler(std::move(publisher), numThreads, [this](const std::string &sessionId, std::string_view answer) { ReceiveAnswer(sessionId, answer); })
+{
+}
+
+void ChatServer::CloseSession(const std::string &sessionId)
+{
+    _scheduler.CloseSession(sessionId);
+}
+
+size_t ChatServer::CloseIdleSessions(std::chrono::steady_clock::duration maxIdleTime)
+{
+    return _scheduler.CloseIdleSessions(maxIdleTime);
+}
+
+size_t ChatServer::MoveIdleSessionsToPublishedGraph()
+{
+    return _scheduler.MoveIdleSessionsToPublishedGraph();
+}
+
+void ChatServer::ReceiveAnswer(const std::string &sessionId, std::string_view answer)
+{
+    // the scheduler answers the messages of a session in the order they were posted, so the n-th answer of a session
+    // belongs to its n-th request of the batch
+    SessionRequests &session = _batchSessions.find(sessionId)->second;
+    (*_batchResponses)[session.indices[session.numAnswered++]].answer.assign(answer.data(), answer.size());
+}
+
+void ChatServer::ProcessBatch(const std::vector<ChatRequest> &requests, std::vector<ChatResponse> &responses)
+{
+    responses.resize(requests.size());
+
+    // group requests by session before the first one is posted, as the workers read the groups without locking
+    _batchSessions.clear();
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        responses[i].sessionId = requests[i].sessionId;
+        responses[i].answer.clear();
+        SessionRequests &session = _batchSessions[requests[i].sessionId];
+        session.indices.push_back(i);
+        session.numAnswered = 0;
+    }
+    _batchResponses = &responses;
+
+    for (const ChatRequest &request : requests)
+        _scheduler.PostMessage(request.sessionId, request.message);
+    _scheduler.WaitUntilIdle();
+    _batchResponses = nullptr;
+}
@@ -0,0 +1,65 @@
+#ifndef CHATSERVER_H_
+#define CHATSERVER_H_
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <string_view>
+#include <chrono>
+#include "graphpublisher.h"
+#include "sessionscheduler.h"
+
+// message of a user, identified by the session (conversation) it belongs to
+struct ChatRequest
+{
+    std::string sessionId;
+    std::string message; // an empty message (re)starts the session and is answered with the welcome answer
+};
+
+// answer of the chatbot to a ChatRequest
+struct ChatResponse
+{
+    std::string sessionId;
+    std::string answer;
+};
+
+// answers requests of many concurrent sessions on one shared answer graph without any GUI
+// the graph can be replaced through the publisher at any time, sessions switch over when they return to the root node
+// requests are processed in batches on the worker threads of a SessionScheduler, which keeps the sessions between
+// batches: the requests of one session are always answered in order while different sessions run in parallel
+class ChatServer
+{
+private:
+    // proprietary type definitions
+    struct SessionRequests
+    {
+        std::vector<size_t> indices; // requests of the session in the current batch, in the order received
+        size_t numAnswered;          // only touched by the worker which currently holds the session
+    };
+
+    // proprietary members
+    std::unordered_map<std::string, SessionRequests> _batchSessions; // not modified while a batch is being answered
+    std::vector<ChatResponse> *_batchResponses;
+    SessionScheduler _scheduler;
+
+    // proprietary functions
+    void ReceiveAnswer(const std::string &sessionId, std::string_view answer);
+
+public:
+    // constructor / destructor
+    ChatServer(std::shared_ptr<const GraphPublisher> publisher, unsigned int numThreads);
+
+    // getter / setter
+    size_t GetNumberOfSessions() { return _scheduler.GetNumberOfSessions(); }
+
+    // proprietary functions
+    // responses[i] is the answer to requests[i], unknown sessions are started at the root node of the graph
+    void ProcessBatch(const std::vector<ChatRequest> &requests, std::vector<ChatResponse> &responses);
+    // sessions may be closed from any thread, requests of the current batch which are discarded get empty answers
+    void CloseSession(const std::string &sessionId);
+    size_t CloseIdleSessions(std::chrono::steady_clock::duration maxIdleTime); // see SessionScheduler::CloseIdleSessions
+    size_t MoveIdleSessionsToPublishedGraph(); // see SessionScheduler::MoveIdleSessionsToPublishedGraph
+};
+
+#endif /* CHATSERVER_H_ */
@@ -0,0 +1,100 @@
+#include <string>
+#include <random>
+#include "levenshtein.h"
+#include "answergraph.h"
+#include "graphpublisher.h"
+#include "chatsession.h"
+
+ChatSession::ChatSession()
+{
+    _currentNode = nullptr;
+    _graphVersion = 0;
+}
+
+ChatSession::ChatSession(std::shared_ptr<const AnswerGraph> graph, uint64_t seed) : _graph(std::move(graph)), _generator(seed)
+{
+    _currentNode = nullptr;
+    _graphVersion = 0;
+}
+
+ChatSession::ChatSession(std::shared_ptr<const GraphPublisher> publisher, uint64_t seed) : _publisher(std::move(publisher)), _generator(seed)
+{
+    _currentNode = nullptr;
+    _graphVersion = _publisher->GetVersion();
+    _graph = _publisher->GetGraph();
+}
+
+std::string_view ChatSession::Start()
+{
+    return EnterRootNode();
+}
+
+std::string_view ChatSession::ReceiveMessage(std::string_view message)
+{
+    if (_currentNode == nullptr)
+        return Start();
+
+    // convert the query to upper-case once per message (keywords have been normalized when the graph was loaded)
+    // the scratch buffer is reused between messages to avoid heap allocations
+    thread_local std::string query;
+    ToUpperCase(message, query);
+
+    // find the edge whose keywords are closest to the query in terms of Levenshtein distance
+    KeywordMatch match = _graph->FindBestMatch(*_currentNode, query);
+
+    // select best fitting edge to proceed along, go back to root node if there is none
+    const GraphNode *node = match.edge != nullptr ? _graph->GetChildNode(*match.edge) : _graph->GetRootNode();
+    if (node == _graph->GetRootNode())
+        return EnterRootNode();
+    else
+        return EnterNode(node);
+}
+
+bool ChatSession::MoveToPublishedGraph()
+{
+    if (_graph == nullptr || _currentNode != _graph->GetRootNode() || !SwitchToPublishedGraph())
+        return false;
+
+    // no answer is selected, the session has already given the welcome answer
+    _currentNode = _graph->GetRootNode();
+    return true;
+}
+
+bool ChatSession::SwitchToPublishedGraph()
+{
+    // the version is checked first, so the shared graph pointer is only read after a new graph has been published
+    if (_publisher == nullptr || _publisher->GetVersion() == _graphVersion)
+        return false;
+
+    _graphVersion = _publisher->GetVersion();
+    std::shared_ptr<const AnswerGraph> graph = _publisher->GetGraph();
+    if (graph == nullptr || graph->GetRootNode() == nullptr)
+        return false;
+
+    _currentNode = nullptr;
+    _graph = std::move(graph); // the previous graph is released here if this was its last session
+    return true;
+}
+
+std::string_view ChatSession::EnterRootNode()
+{
+    SwitchToPublishedGraph();
+
+    if (_graph == nullptr || _graph->GetRootNode() == nullptr)
+        return std::string_view();
+
+    return EnterNode(_graph->GetRootNode());
+}
+
+std::string_view ChatSession::EnterNode(const GraphNode *node)
+{
+    // update pointer to current node
+    _currentNode = node;
+
+    if (_currentNode->GetNumberOfAnswers() == 0)
+        return std::string_view();
+
+    // select a random node answer (if several answers should exist), the answer is returned as a view into the graph
+    std::uniform_int_distribution<uint32_t> dis(0, _currentNode->GetNumberOfAnswers() - 1);
+    return _graph->GetAnswer(*_currentNode, dis(_generator));
+}
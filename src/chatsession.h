@@ -0,0 +1,60 @@
+#ifndef CHATSESSION_H_
+#define CHATSESSION_H_
+
+#include <memory>
+#include <string_view>
+#include <cstdint>
+#include "pcg32.h"
+
+// forward declarations
+class AnswerGraph;
+class GraphNode;
+class GraphPublisher;
+
+// state of a single conversation: the current position in the answer graph and the random generator for answer selection
+// the graph is immutable and only read by sessions, so any number of sessions (on any number of threads) can share one graph
+// a session is a small value which can be copied or moved cheaply, it keeps its graph alive as long as it exists
+// sessions created from a GraphPublisher move to a newly published graph whenever they return to the root node,
+// so a conversation never jumps between graphs in the middle of a dialog
+class ChatSession
+{
+private:
+    // data handles (shared)
+    std::shared_ptr<const AnswerGraph> _graph;
+    std::shared_ptr<const GraphPublisher> _publisher; // nullptr if the session stays on its graph
+
+    // data handles (not owned)
+    const GraphNode *_currentNode; // nullptr until the session has been started
+
+    // proprietary members
+    Pcg32 _generator; // lives as long as the session, so consecutive answers continue one random sequence
+    uint64_t _graphVersion; // version of the publisher _graph has been taken from
+
+    // proprietary functions
+    bool SwitchToPublishedGraph(); // returns true if the graph has been replaced, the session has to enter its root then
+    std::string_view EnterRootNode(); // switches to the published graph if it has been replaced
+    std::string_view EnterNode(const GraphNode *node);
+
+public:
+    // constructor / destructor
+    ChatSession();
+    ChatSession(std::shared_ptr<const AnswerGraph> graph, uint64_t seed);
+    ChatSession(std::shared_ptr<const GraphPublisher> publisher, uint64_t seed); // follows the graphs published
+
+    // getter / setter
+    bool IsStarted() const { return _currentNode != nullptr; }
+    const AnswerGraph *GetAnswerGraph() const { return _graph.get(); }
+    const GraphNode *GetCurrentNode() const { return _currentNode; }
+
+    // communication
+    // both functions return the answer of the node the session is in afterwards (empty if the node has no answers)
+    // answers are views into the graph, which stay valid as long as the session holds on to the graph
+    std::string_view Start(); // enter the root node
+    std::string_view ReceiveMessage(std::string_view message);
+
+    // moves a session which is waiting at the root node to a newly published graph right away instead of with its next
+    // message, so idle sessions do not keep the previous graph alive; sessions in the middle of a dialog stay where they are
+    bool MoveToPublishedGraph();
+};
+
+#endif /* CHATSESSION_H_ */
@@ -1,22 +1,15 @@
-#include "graphnode.h"
 #include "graphedge.h"
 
-GraphEdge::GraphEdge(int id)
+GraphEdge::GraphEdge(int id, uint32_t parentNode, uint32_t childNode)
 {
     _id = id;
-}
-
-void GraphEdge::SetChildNode(GraphNode *childNode)
-{
+    _parentNode = parentNode;
     _childNode = childNode;
+    _firstKeyword = _numKeywords = 0;
 }
 
-void GraphEdge::SetParentNode(GraphNode *parentNode)
+void GraphEdge::SetKeywords(uint32_t first, uint32_t count)
 {
-    _parentNode = parentNode;
+    _firstKeyword = first;
+    _numKeywords = count;
 }
-
-void GraphEdge::AddToken(std::string token)
-{
-    _keywords.push_back(token);
-}
\ No newline at end of file
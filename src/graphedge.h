@@ -1,36 +1,31 @@
 #ifndef GRAPHEDGE_H_
 #define GRAPHEDGE_H_
 
-#include <vector>
-#include <string>
-
-class GraphNode; // forward declaration
+#include <cstdint>
 
+// edge of an AnswerGraph
+// nodes and keywords are referenced by index into the graph-wide tables (see GraphNode)
 class GraphEdge
 {
 private:
-    // data handles (not owned)
-    GraphNode *_childNode;
-    GraphNode *_parentNode;
-
     // proprietary members
-    int _id;
-    std::vector<std::string> _keywords; // list of topics associated with this edge
-    
+    int32_t _id;
+    uint32_t _parentNode; // index into the node table
+    uint32_t _childNode;
+    uint32_t _firstKeyword; // index into the edge keyword table (keywords as written in the source file)
+    uint32_t _numKeywords;
 
 public:
     // constructor / desctructor
-    GraphEdge(int id);
+    GraphEdge(int id, uint32_t parentNode, uint32_t childNode);
 
     // getter / setter
-    int GetID() { return _id; }
-    void SetChildNode(GraphNode *childNode);
-    void SetParentNode(GraphNode *parentNode);
-    GraphNode *GetChildNode() { return _childNode; }
-    std::vector<std::string> GetKeywords() { return _keywords; }
-
-    // proprietary functions
-    void AddToken(std::string token);
+    int GetID() const { return _id; }
+    uint32_t GetParentNode() const { return _parentNode; }
+    uint32_t GetChildNode() const { return _childNode; }
+    uint32_t GetFirstKeyword() const { return _firstKeyword; }
+    uint32_t GetNumberOfKeywords() const { return _numKeywords; }
+    void SetKeywords(uint32_t first, uint32_t count);
 };
 
-#endif /* GRAPHEDGE_H_ */
\ No newline at end of file
+#endif /* GRAPHEDGE_H_ */
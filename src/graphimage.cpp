@@ -0,0 +1,332 @@
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include "graphparser.h"
+#include "levenshtein.h"
+#include "metrics.h"
+#include "graphimage.h"
+
+// all tables start at a multiple of this value so they can be accessed in place
+const uint64_t tableAlignment = 8;
+
+static uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + tableAlignment - 1) / tableAlignment * tableAlignment;
+}
+
+GraphImageBuilder::GraphImageBuilder() : _internedStrings(0, StringHash{this}, StringEqual{this})
+{
+    _isPoolFull = false;
+}
+
+uint32_t GraphImageBuilder::InternString(std::string_view str)
+{
+    // identical strings (e.g. keywords shared by many edges) are stored only once
+    // the string is appended as a candidate first, so it is looked up by its ID without copying it into a temporary
+    // offsets are 32 bit wide, so a string which would end beyond 4 GB can only be found among the existing ones
+    if (_stringPool.size() + str.size() > UINT32_MAX || _strings.size() >= invalidIndex)
+    {
+        _lookupString = str;
+        auto existing = _internedStrings.find(invalidIndex);
+        if (existing != _internedStrings.end())
+            return *existing;
+
+        _isPoolFull = true;
+        return invalidIndex;
+    }
+
+    uint32_t id = _strings.size();
+    _strings.push_back(ImageString{static_cast<uint32_t>(_stringPool.size()), static_cast<uint32_t>(str.size())});
+    _stringPool.append(str);
+
+    auto interned = _internedStrings.insert(id);
+    if (!interned.second)
+    {
+        _stringPool.resize(_strings.back().offset);
+        _strings.pop_back();
+    }
+    return *interned.first;
+}
+
+void GraphImageBuilder::AddRecords(const GraphRecordTable &records)
+{
+    for (size_t i = 0; i < records.numMissingIds; ++i)
+        std::cout << "Error: ID missing. Line is ignored!" << std::endl;
+
+    // node-based processing, only the first node with a given ID is used
+    for (const GraphRecordEntry &record : records.nodes)
+    {
+        if (_nodeIndex.find(record.id) != _nodeIndex.end())
+            continue;
+
+        GraphNode node(record.id);
+        node.SetAnswers(_answers.size(), record.numStrings);
+        for (uint32_t i = record.firstString; i < record.firstString + record.numStrings; ++i)
+            _answers.push_back(InternString(records.strings[i]));
+
+        _nodeIndex.emplace(record.id, static_cast<uint32_t>(_nodes.size()));
+        _nodes.push_back(node);
+        _numParents.push_back(0);
+    }
+
+    // edge-based processing
+    for (const GraphRecordEntry &record : records.edges)
+    {
+        auto parentNode = _nodeIndex.find(record.parentId);
+        auto childNode = _nodeIndex.find(record.childId);
+        if (parentNode == _nodeIndex.end() || childNode == _nodeIndex.end())
+        {
+            std::cout << "Error: Edge " << record.id << " refers to an unknown node. Line is ignored!" << std::endl;
+            continue;
+        }
+
+        GraphEdge edge(record.id, parentNode->second, childNode->second);
+        edge.SetKeywords(_edgeKeywords.size(), record.numStrings);
+        for (uint32_t i = record.firstString; i < record.firstString + record.numStrings; ++i)
+            _edgeKeywords.push_back(InternString(records.strings[i]));
+
+        _numParents[childNode->second]++;
+        _edges.push_back(edge);
+    }
+}
+
+bool GraphImageBuilder::Build(std::vector<char> &image)
+{
+    GraphImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, graphImageMagic, sizeof(header.magic));
+    header.version = graphImageVersion;
+    header.byteOrder = graphImageByteOrder;
+    header.rootNode = invalidIndex;
+
+    // identify root node
+    {
+        ScopedTimer timer(MetricHistogram::LoadRootDetection);
+        for (size_t i = 0; i < _nodes.size(); ++i)
+        {
+            if (_numParents[i] == 0)
+            {
+                if (header.rootNode == invalidIndex)
+                    header.rootNode = i;
+                else
+                    std::cout << "ERROR : Multiple root nodes detected" << std::endl;
+            }
+        }
+    }
+    ScopedTimer layoutTimer(MetricHistogram::LoadLayout);
+
+    // string references are 32 bit wide, strings which did not fit have no ID
+    if (_isPoolFull)
+    {
+        std::cout << "Error: String pool exceeds 4 GB, image cannot be built!" << std::endl;
+        return false;
+    }
+
+    // group child edges by parent node while keeping the file order within each group
+    std::vector<uint32_t> numChildEdges(_nodes.size(), 0);
+    std::vector<uint32_t> edgeOrder(_edges.size());
+    for (const GraphEdge &edge : _edges)
+        numChildEdges[edge.GetParentNode()]++;
+    uint32_t firstChildEdge = 0;
+    for (size_t i = 0; i < _nodes.size(); ++i)
+    {
+        _nodes[i].SetChildEdges(firstChildEdge, numChildEdges[i]);
+        firstChildEdge += numChildEdges[i];
+        numChildEdges[i] = 0;
+    }
+    for (size_t i = 0; i < _edges.size(); ++i)
+    {
+        uint32_t parent = _edges[i].GetParentNode();
+        edgeOrder[_nodes[parent].GetFirstChildEdge() + numChildEdges[parent]++] = i;
+    }
+
+    // normalize every distinct keyword once, no matter how many edges share it
+    std::vector<uint32_t> normalizedStrings(_strings.size(), invalidIndex); // string ID -> ID of its normalized form
+    std::string normalized;
+    for (uint32_t keyword : _edgeKeywords)
+    {
+        if (normalizedStrings[keyword] == invalidIndex)
+        {
+            ToUpperCase(GetString(keyword), normalized);
+            normalizedStrings[keyword] = InternString(normalized);
+        }
+    }
+    if (_isPoolFull)
+    {
+        std::cout << "Error: String pool exceeds 4 GB, image cannot be built!" << std::endl;
+        return false;
+    }
+
+    // build edge table, keyword tables and the normalized keywords of every node
+    std::vector<GraphEdge> edges;
+    std::vector<uint32_t> edgeKeywordIds;
+    std::vector<ImageString> edgeKeywords;
+    std::vector<ImageKeyword> nodeKeywords;
+    edges.reserve(_edges.size());
+    edgeKeywordIds.reserve(_edgeKeywords.size());
+    for (uint32_t index : edgeOrder)
+    {
+        GraphEdge edge = _edges[index];
+        auto firstKeyword = _edgeKeywords.begin() + edge.GetFirstKeyword();
+        edge.SetKeywords(edgeKeywordIds.size(), edge.GetNumberOfKeywords());
+        edgeKeywordIds.insert(edgeKeywordIds.end(), firstKeyword, firstKeyword + edge.GetNumberOfKeywords());
+        edges.push_back(edge);
+    }
+    for (uint32_t keyword : edgeKeywordIds)
+        edgeKeywords.push_back(_strings[keyword]);
+
+    // keywords which are written twice on the same edge (e.g. "yes" and "Yes") are only listed once per node,
+    // the second one could never be the first closest keyword, so matching is not affected
+    std::vector<uint32_t> lastEdges(_strings.size(), invalidIndex); // string ID -> edge which has used it last
+    for (GraphNode &node : _nodes)
+    {
+        uint32_t firstKeyword = nodeKeywords.size();
+        for (uint32_t e = node.GetFirstChildEdge(); e < node.GetFirstChildEdge() + node.GetNumberOfChildEdges(); ++e)
+        {
+            for (uint32_t k = edges[e].GetFirstKeyword(); k < edges[e].GetFirstKeyword() + edges[e].GetNumberOfKeywords(); ++k)
+            {
+                uint32_t keyword = normalizedStrings[edgeKeywordIds[k]];
+                if (lastEdges[keyword] == e)
+                    continue;
+                lastEdges[keyword] = e;
+                nodeKeywords.push_back(ImageKeyword{_strings[keyword], e});
+            }
+        }
+        node.SetKeywords(firstKeyword, nodeKeywords.size() - firstKeyword);
+    }
+
+    std::vector<ImageString> answers;
+    answers.reserve(_answers.size());
+    for (uint32_t answer : _answers)
+        answers.push_back(_strings[answer]);
+
+    // lay out all tables behind the header
+    header.numNodes = _nodes.size();
+    header.numEdges = edges.size();
+    header.numAnswers = answers.size();
+    header.numEdgeKeywords = edgeKeywords.size();
+    header.numNodeKeywords = nodeKeywords.size();
+    header.stringPoolSize = _stringPool.size();
+    header.nodesOffset = AlignOffset(sizeof(header));
+    header.edgesOffset = AlignOffset(header.nodesOffset + _nodes.size() * sizeof(GraphNode));
+    header.answersOffset = AlignOffset(header.edgesOffset + edges.size() * sizeof(GraphEdge));
+    header.edgeKeywordsOffset = AlignOffset(header.answersOffset + answers.size() * sizeof(ImageString));
+    header.nodeKeywordsOffset = AlignOffset(header.edgeKeywordsOffset + edgeKeywords.size() * sizeof(ImageString));
+    header.stringPoolOffset = AlignOffset(header.nodeKeywordsOffset + nodeKeywords.size() * sizeof(ImageKeyword));
+
+    // copy all tables into one zero-initialized block, so the gaps between the tables are padded with zeros
+    image.assign(header.stringPoolOffset + _stringPool.size(), 0);
+    auto copyTable = [&image](uint64_t offset, const void *data, size_t size) {
+        if (size > 0)
+            std::memcpy(image.data() + offset, data, size);
+    };
+    copyTable(0, &header, sizeof(header));
+    copyTable(header.nodesOffset, _nodes.data(), _nodes.size() * sizeof(GraphNode));
+    copyTable(header.edgesOffset, edges.data(), edges.size() * sizeof(GraphEdge));
+    copyTable(header.answersOffset, answers.data(), answers.size() * sizeof(ImageString));
+    copyTable(header.edgeKeywordsOffset, edgeKeywords.data(), edgeKeywords.size() * sizeof(ImageString));
+    copyTable(header.nodeKeywordsOffset, nodeKeywords.data(), nodeKeywords.size() * sizeof(ImageKeyword));
+    copyTable(header.stringPoolOffset, _stringPool.data(), _stringPool.size());
+
+    return true;
+}
+
+bool GraphImageBuilder::Write(const std::string &filename)
+{
+    std::vector<char> image;
+    if (!Build(image))
+        return false;
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cout << "File could not be opened!" << std::endl;
+        return false;
+    }
+
+    file.write(image.data(), image.size());
+    return static_cast<bool>(file);
+}
+
+GraphImage::GraphImage()
+{
+    _data = nullptr;
+    _header = nullptr;
+}
+
+bool GraphImage::IsGraphImage(std::string_view content)
+{
+    return content.size() >= sizeof(graphImageMagic) && std::memcmp(content.data(), graphImageMagic, sizeof(graphImageMagic)) == 0;
+}
+
+bool GraphImage::Open(std::string_view content)
+{
+    _data = nullptr;
+    _header = nullptr;
+
+    if (!IsGraphImage(content) || content.size() < sizeof(GraphImageHeader))
+        return false;
+
+    const GraphImageHeader *header = reinterpret_cast<const GraphImageHeader *>(content.data());
+    if (header->version != graphImageVersion || header->byteOrder != graphImageByteOrder)
+    {
+        std::cout << "Error: Graph image has been compiled for a different version or platform!" << std::endl;
+        return false;
+    }
+
+    // only the table bounds are checked, so opening an image takes constant time
+    auto isValidTable = [&content](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % tableAlignment == 0 && offset <= content.size() && count <= (content.size() - offset) / elementSize;
+    };
+    if (!isValidTable(header->nodesOffset, header->numNodes, sizeof(GraphNode)) ||
+        !isValidTable(header->edgesOffset, header->numEdges, sizeof(GraphEdge)) ||
+        !isValidTable(header->answersOffset, header->numAnswers, sizeof(ImageString)) ||
+        !isValidTable(header->edgeKeywordsOffset, header->numEdgeKeywords, sizeof(ImageString)) ||
+        !isValidTable(header->nodeKeywordsOffset, header->numNodeKeywords, sizeof(ImageKeyword)) ||
+        !isValidTable(header->stringPoolOffset, header->stringPoolSize, 1) ||
+        (header->rootNode != invalidIndex && header->rootNode >= header->numNodes))
+    {
+        std::cout << "Error: Graph image is truncated or corrupt!" << std::endl;
+        return false;
+    }
+
+    _data = content.data();
+    _header = header;
+    return true;
+}
+
+bool GraphImage::Validate() const
+{
+    if (!IsOpen())
+        return false;
+
+    // ranges are checked in 64 bit, so first index + count cannot wrap around
+    const GraphImageHeader &header = GetHeader();
+    auto isValidRange = [](uint64_t first, uint64_t count, uint64_t size) { return first + count <= size; };
+    auto isValidString = [&header, &isValidRange](const ImageString &str) { return isValidRange(str.offset, str.length, header.stringPoolSize); };
+
+    bool isValid = true;
+    for (uint32_t i = 0; i < header.numNodes && isValid; ++i)
+    {
+        const GraphNode &node = GetNodes()[i];
+        isValid = isValidRange(node.GetFirstAnswer(), node.GetNumberOfAnswers(), header.numAnswers) &&
+                  isValidRange(node.GetFirstChildEdge(), node.GetNumberOfChildEdges(), header.numEdges) &&
+                  isValidRange(node.GetFirstKeyword(), node.GetNumberOfKeywords(), header.numNodeKeywords);
+    }
+    for (uint32_t i = 0; i < header.numEdges && isValid; ++i)
+    {
+        const GraphEdge &edge = GetEdges()[i];
+        isValid = edge.GetParentNode() < header.numNodes && edge.GetChildNode() < header.numNodes &&
+                  isValidRange(edge.GetFirstKeyword(), edge.GetNumberOfKeywords(), header.numEdgeKeywords);
+    }
+    for (uint32_t i = 0; i < header.numAnswers && isValid; ++i)
+        isValid = isValidString(GetAnswers()[i]);
+    for (uint32_t i = 0; i < header.numEdgeKeywords && isValid; ++i)
+        isValid = isValidString(GetEdgeKeywords()[i]);
+    for (uint32_t i = 0; i < header.numNodeKeywords && isValid; ++i)
+        isValid = isValidString(GetNodeKeywords()[i].keyword) && GetNodeKeywords()[i].edge < header.numEdges;
+
+    if (!isValid)
+        std::cout << "Error: Graph image contains invalid indices!" << std::endl;
+    return isValid;
+}
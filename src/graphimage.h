@@ -0,0 +1,154 @@
+#ifndef GRAPHIMAGE_H_
+#define GRAPHIMAGE_H_
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <type_traits>
+#include "graphnode.h"
+#include "graphedge.h"
+
+struct GraphRecordTable; // forward declaration
+
+// binary answer graph image as produced by the graph compiler (membotc)
+// the image starts with a header followed by the tables below, all of them in host byte order
+// child edges are stored in CSR layout (grouped by parent node), so a node refers to its edges by a single range
+// all strings are interned into one pool and the keywords of each node are stored in normalized (upper-case) form
+// the same layout is used in memory for graphs loaded from text files, so both are accessed in place
+
+const char graphImageMagic[8] = {'M', 'E', 'M', 'B', 'O', 'T', 'G', '\0'};
+const uint32_t graphImageVersion = 2;
+const uint32_t graphImageByteOrder = 0x01020304; // detects images compiled on a machine with a different byte order
+const uint32_t invalidIndex = UINT32_MAX;
+
+// reference to a string inside the string pool
+struct ImageString
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+// normalized keyword of one of the child edges of a node
+struct ImageKeyword
+{
+    ImageString keyword;
+    uint32_t edge; // index into the edge table
+};
+
+// node and edge records are copied into / mapped from images byte by byte
+static_assert(std::is_trivially_copyable<GraphNode>::value && std::is_standard_layout<GraphNode>::value, "GraphNode must be a plain record");
+static_assert(std::is_trivially_copyable<GraphEdge>::value && std::is_standard_layout<GraphEdge>::value, "GraphEdge must be a plain record");
+
+struct GraphImageHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t rootNode; // index of the root node or invalidIndex if there is none
+    uint32_t numNodes;
+    uint32_t numEdges;
+    uint32_t numAnswers;
+    uint32_t numEdgeKeywords;
+    uint32_t numNodeKeywords;
+    uint64_t stringPoolSize;
+
+    // offsets of the tables relative to the start of the image
+    uint64_t nodesOffset;        // GraphNode[numNodes]
+    uint64_t edgesOffset;        // GraphEdge[numEdges]
+    uint64_t answersOffset;      // ImageString[numAnswers]
+    uint64_t edgeKeywordsOffset; // ImageString[numEdgeKeywords], keywords as written in the source file
+    uint64_t nodeKeywordsOffset; // ImageKeyword[numNodeKeywords]
+    uint64_t stringPoolOffset;   // char[stringPoolSize]
+};
+
+// collects the records of an answer graph file and turns them into an image (in memory or as file)
+// this is where nodes and edges are resolved by their IDs and the root node is identified
+// all strings are interned while the records are added: identical answers and keywords are stored once and referred to
+// by a compact string ID, so work on strings (e.g. normalizing keywords) is done once per distinct string
+class GraphImageBuilder
+{
+private:
+    // proprietary type definitions
+    // the set of interned strings holds string IDs and compares the strings they refer to
+    struct StringHash
+    {
+        const GraphImageBuilder *builder;
+        size_t operator()(uint32_t id) const { return std::hash<std::string_view>()(builder->GetString(id)); }
+    };
+
+    struct StringEqual
+    {
+        const GraphImageBuilder *builder;
+        bool operator()(uint32_t id1, uint32_t id2) const { return builder->GetString(id1) == builder->GetString(id2); }
+    };
+
+    // proprietary members
+    std::vector<GraphNode> _nodes;
+    std::vector<uint32_t> _numParents;   // incoming edges per node, only needed to identify the root node
+    std::vector<GraphEdge> _edges;       // in file order
+    std::vector<uint32_t> _edgeKeywords; // string IDs in file order, edges refer to their keywords in here until they are laid out
+    std::vector<uint32_t> _answers;      // string IDs
+    std::unordered_map<int, uint32_t> _nodeIndex; // node ID -> index into _nodes
+    std::string _stringPool;
+    std::vector<ImageString> _strings; // string ID -> location in _stringPool
+    std::unordered_set<uint32_t, StringHash, StringEqual> _internedStrings;
+    std::string_view _lookupString; // looked up as ID invalidIndex, for strings which cannot be appended to the pool
+    bool _isPoolFull;                // a string did not fit into the 4 GB addressable by string references
+
+    // proprietary functions
+    std::string_view GetString(uint32_t id) const { return id == invalidIndex ? _lookupString : std::string_view(_stringPool).substr(_strings[id].offset, _strings[id].length); }
+    uint32_t InternString(std::string_view str); // returns the string ID, invalidIndex if the pool is full
+
+public:
+    // constructor / destructor
+    GraphImageBuilder();
+    GraphImageBuilder(const GraphImageBuilder &source) = delete; // the string set refers to this object
+    GraphImageBuilder &operator=(const GraphImageBuilder &source) = delete;
+
+    // getter / setter
+    size_t GetNumberOfNodes() const { return _nodes.size(); }
+    size_t GetNumberOfEdges() const { return _edges.size(); }
+    size_t GetNumberOfStrings() const { return _strings.size(); } // distinct strings
+    size_t GetStringPoolSize() const { return _stringPool.size(); }
+
+    // proprietary functions
+    void AddRecords(const GraphRecordTable &records);
+    bool Build(std::vector<char> &image);
+    bool Write(const std::string &filename);
+};
+
+// read-only access to an image held in memory (e.g. a memory-mapped file)
+// images are trusted input: Open only checks the header, so opening takes constant time, while the indices inside the
+// tables are used as they are; images of unknown origin have to be checked with Validate before they are used
+class GraphImage
+{
+private:
+    // data handles (not owned)
+    const char *_data;
+    const GraphImageHeader *_header;
+
+public:
+    // constructor / destructor
+    GraphImage();
+
+    // getter / setter
+    bool IsOpen() const { return _header != nullptr; }
+    const GraphImageHeader &GetHeader() const { return *_header; }
+    const GraphNode *GetNodes() const { return reinterpret_cast<const GraphNode *>(_data + _header->nodesOffset); }
+    const GraphEdge *GetEdges() const { return reinterpret_cast<const GraphEdge *>(_data + _header->edgesOffset); }
+    const ImageString *GetAnswers() const { return reinterpret_cast<const ImageString *>(_data + _header->answersOffset); }
+    const ImageString *GetEdgeKeywords() const { return reinterpret_cast<const ImageString *>(_data + _header->edgeKeywordsOffset); }
+    const ImageKeyword *GetNodeKeywords() const { return reinterpret_cast<const ImageKeyword *>(_data + _header->nodeKeywordsOffset); }
+    const char *GetStringPool() const { return _data + _header->stringPoolOffset; }
+    std::string_view GetString(const ImageString &str) const { return std::string_view(_data + _header->stringPoolOffset + str.offset, str.length); }
+
+    // proprietary functions
+    static bool IsGraphImage(std::string_view content);
+    bool Open(std::string_view content); // checks that all tables lie within content and the root node index
+    bool Validate() const;                // checks every index and string reference in the tables, linear in the image size
+};
+
+#endif /* GRAPHIMAGE_H_ */
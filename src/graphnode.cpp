@@ -1,37 +1,27 @@
-#include "graphedge.h"
 #include "graphnode.h"
 
-GraphNode::GraphNode(int id) { _id = id; }
-
-GraphNode::~GraphNode() {}
-
-void GraphNode::AddToken(std::string token)
+GraphNode::GraphNode(int id)
 {
-    _answers.emplace_back(token);
+    _id = id;
+    _firstAnswer = _numAnswers = 0;
+    _firstChildEdge = _numChildEdges = 0;
+    _firstKeyword = _numKeywords = 0;
 }
 
-void GraphNode::AddEdgeToParentNode(GraphEdge *edge)
+void GraphNode::SetAnswers(uint32_t first, uint32_t count)
 {
-    _parentEdges.emplace_back(edge);
+    _firstAnswer = first;
+    _numAnswers = count;
 }
 
-void GraphNode::AddEdgeToChildNode(std::unique_ptr<GraphEdge> edge)
+void GraphNode::SetChildEdges(uint32_t first, uint32_t count)
 {
-    _childEdges.emplace_back(std::move(edge));
+    _firstChildEdge = first;
+    _numChildEdges = count;
 }
 
-void GraphNode::MoveChatbotHere(ChatBot chatbot)
+void GraphNode::SetKeywords(uint32_t first, uint32_t count)
 {
-    _chatBot = std::move(chatbot);
-    _chatBot.SetCurrentNode(this);
+    _firstKeyword = first;
+    _numKeywords = count;
 }
-
-void GraphNode::MoveChatbotToNewNode(GraphNode *newNode)
-{
-    newNode->MoveChatbotHere(std::move(_chatBot));
-}
-
-GraphEdge *GraphNode::GetChildEdgeAtIndex(int index)
-{
-    return _childEdges[index].get();
-}
\ No newline at end of file
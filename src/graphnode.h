@@ -1,46 +1,38 @@
 #ifndef GRAPHNODE_H_
 #define GRAPHNODE_H_
 
-#include <vector>
-#include <string>
-#include <memory>
-#include "chatbot.h"
-
-// forward declarations
-class GraphEdge;
+#include <cstdint>
 
+// node of an AnswerGraph
+// answers, child edges and keywords are referenced by index ranges into the graph-wide tables,
+// so nodes are plain values which are stored contiguously (and mapped directly from compiled graph images)
 class GraphNode
 {
 private:
-    // data handles (owned)
-    std::vector<std::unique_ptr<GraphEdge>> _childEdges;  // GraphNodes exclusively own child edges
-
-    // data handles (not owned)
-    std::vector<GraphEdge *> _parentEdges; // edges to preceding nodes
-    ChatBot _chatBot;
-
     // proprietary members
-    int _id;
-    std::vector<std::string> _answers;
+    int32_t _id;
+    uint32_t _firstAnswer; // index into the answer table
+    uint32_t _numAnswers;
+    uint32_t _firstChildEdge; // index into the edge table (child edges of a node are stored consecutively)
+    uint32_t _numChildEdges;
+    uint32_t _firstKeyword; // index into the normalized keyword table
+    uint32_t _numKeywords;
 
 public:
     // constructor / destructor
     GraphNode(int id);
-    ~GraphNode();
 
     // getter / setter
-    int GetID() { return _id; }
-    int GetNumberOfChildEdges() { return _childEdges.size(); }
-    GraphEdge *GetChildEdgeAtIndex(int index);
-    std::vector<std::string> GetAnswers() { return _answers; }
-    int GetNumberOfParents() { return _parentEdges.size(); }
-
-    // proprietary functions
-    void AddToken(std::string token); // add answers to list
-    void AddEdgeToParentNode(GraphEdge *edge);
-    void AddEdgeToChildNode(std::unique_ptr<GraphEdge> edge);
-    void MoveChatbotHere(ChatBot chatbot);
-    void MoveChatbotToNewNode(GraphNode *newNode);
+    int GetID() const { return _id; }
+    uint32_t GetFirstAnswer() const { return _firstAnswer; }
+    uint32_t GetNumberOfAnswers() const { return _numAnswers; }
+    uint32_t GetFirstChildEdge() const { return _firstChildEdge; }
+    uint32_t GetNumberOfChildEdges() const { return _numChildEdges; }
+    uint32_t GetFirstKeyword() const { return _firstKeyword; }
+    uint32_t GetNumberOfKeywords() const { return _numKeywords; }
+    void SetAnswers(uint32_t first, uint32_t count);
+    void SetChildEdges(uint32_t first, uint32_t count);
+    void SetKeywords(uint32_t first, uint32_t count);
 };
 
-#endif /* GRAPHNODE_H_ */
\ No newline at end of file
+#endif /* GRAPHNODE_H_ */
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <functional>
+#include <thread>
+#include "graphparser.h"
+
+// chunks are not made smaller than this, so small files are parsed by the calling thread only
+const size_t minChunkSize = 1 << 20;
+
+// number of bytes a chunk parses between two progress updates
+const size_t progressInterval = 1 << 18;
+
+// progress of all chunks of a file
+struct ParseProgress
+{
+    std::atomic<size_t> numParsedBytes;
+    size_t numBytes;
+    const ParseProgressCallback *callback; // only called by the thread which has started parsing
+
+    void Report() const
+    {
+        if (*callback && numBytes > 0)
+            (*callback)(static_cast<float>(numParsedBytes.load(std::memory_order_relaxed)) / numBytes);
+    }
+};
+
+// convert the info part of an ID token, returns false if it is not a number
+static bool ParseId(std::string_view info, int &id)
+{
+    auto result = std::from_chars(info.data(), info.data() + info.size(), id);
+    return result.ec == std::errc();
+}
+
+TokenType GetTokenType(std::string_view name)
+{
+    if (name == "TYPE")
+        return TokenType::Type;
+    if (name == "ID")
+        return TokenType::Id;
+    if (name == "ANSWER")
+        return TokenType::Answer;
+    if (name == "PARENT")
+        return TokenType::Parent;
+    if (name == "CHILD")
+        return TokenType::Child;
+    if (name == "KEYWORD")
+        return TokenType::Keyword;
+    return TokenType::Unknown;
+}
+
+void ParseGraphRecord(std::string_view line, GraphRecord &record)
+{
+    record.type = RecordType::None;
+    record.hasId = record.hasParent = record.hasChild = false;
+    record.id = record.parentId = record.childId = 0;
+    record.answers.clear();
+    record.keywords.clear();
+
+    size_t pos = 0;
+    while (pos < line.size())
+    {
+        // extract next token, quit loop if no complete token has been found
+        size_t posTokenFront = line.find('<', pos);
+        if (posTokenFront == std::string_view::npos)
+            break;
+        size_t posTokenBack = line.find('>', posTokenFront + 1);
+        if (posTokenBack == std::string_view::npos)
+            break;
+        std::string_view token = line.substr(posTokenFront + 1, posTokenBack - posTokenFront - 1);
+        pos = posTokenBack + 1;
+
+        // split token into type and info, tokens without info are ignored
+        size_t posTokenInfo = token.find(':');
+        if (posTokenInfo == std::string_view::npos)
+            continue;
+        std::string_view info = token.substr(posTokenInfo + 1);
+
+        // only the first occurrence of single-valued tokens is used
+        switch (GetTokenType(token.substr(0, posTokenInfo)))
+        {
+        case TokenType::Type:
+            if (record.type == RecordType::None)
+                record.type = info == "NODE" ? RecordType::Node : (info == "EDGE" ? RecordType::Edge : RecordType::Unknown);
+            break;
+        case TokenType::Id:
+            if (!record.hasId)
+                record.hasId = ParseId(info, record.id);
+            break;
+        case TokenType::Parent:
+            if (!record.hasParent)
+                record.hasParent = ParseId(info, record.parentId);
+            break;
+        case TokenType::Child:
+            if (!record.hasChild)
+                record.hasChild = ParseId(info, record.childId);
+            break;
+        case TokenType::Answer:
+            record.answers.push_back(info);
+            break;
+        case TokenType::Keyword:
+            record.keywords.push_back(info);
+            break;
+        case TokenType::Unknown:
+            break;
+        }
+    }
+}
+
+// tokenize all lines of a chunk and append their records to table, isReporting is only set for the calling thread
+static void ParseGraphRecordChunk(std::string_view chunk, GraphRecordTable &table, ParseProgress &progress, bool isReporting)
+{
+    GraphRecord record;
+    size_t chunkSize = chunk.size();
+    size_t numReportedBytes = 0;
+    while (!chunk.empty())
+    {
+        size_t numParsedBytes = chunkSize - chunk.size();
+        if (numParsedBytes - numReportedBytes >= progressInterval)
+        {
+            progress.numParsedBytes.fetch_add(numParsedBytes - numReportedBytes, std::memory_order_relaxed);
+            numReportedBytes = numParsedBytes;
+            if (isReporting)
+                progress.Report();
+        }
+
+        size_t posLineEnd = chunk.find('\n');
+        std::string_view lineStr = chunk.substr(0, posLineEnd);
+        chunk.remove_prefix(posLineEnd == std::string_view::npos ? chunk.size() : posLineEnd + 1);
+
+        ParseGraphRecord(lineStr, record);
+        if (record.type == RecordType::None)
+            continue;
+
+        if (!record.hasId)
+        {
+            table.numMissingIds++;
+            continue;
+        }
+
+        const std::vector<std::string_view> *strings = nullptr;
+        std::vector<GraphRecordEntry> *entries = nullptr;
+        if (record.type == RecordType::Node)
+        {
+            strings = &record.answers;
+            entries = &table.nodes;
+        }
+        else if (record.type == RecordType::Edge && record.hasParent && record.hasChild)
+        {
+            strings = &record.keywords;
+            entries = &table.edges;
+        }
+        else
+        {
+            continue;
+        }
+
+        entries->push_back(GraphRecordEntry{record.id, record.parentId, record.childId, record.hasParent, record.hasChild,
+                                            static_cast<uint32_t>(table.strings.size()), static_cast<uint32_t>(strings->size())});
+        table.strings.insert(table.strings.end(), strings->begin(), strings->end());
+    }
+    progress.numParsedBytes.fetch_add(chunkSize - numReportedBytes, std::memory_order_relaxed);
+}
+
+void ParseGraphRecords(std::string_view content, unsigned int numThreads, GraphRecordTable &table, const ParseProgressCallback &progressCallback)
+{
+    table.nodes.clear();
+    table.edges.clear();
+    table.strings.clear();
+    table.numMissingIds = 0;
+
+    // split content into line-aligned chunks of roughly equal size
+    size_t numChunks = std::max<size_t>(1, std::min<size_t>(numThreads, content.size() / minChunkSize));
+    std::vector<std::string_view> chunks;
+    size_t chunkStart = 0;
+    for (size_t i = 1; i <= numChunks && chunkStart < content.size(); ++i)
+    {
+        size_t chunkEnd = i == numChunks ? content.size() : content.find('\n', std::max(chunkStart, content.size() / numChunks * i));
+        chunkEnd = chunkEnd == std::string_view::npos ? content.size() : chunkEnd + 1;
+        chunks.push_back(content.substr(chunkStart, chunkEnd - chunkStart));
+        chunkStart = chunkEnd;
+    }
+
+    ParseProgress progress{{0}, content.size(), &progressCallback};
+    if (chunks.size() <= 1)
+    {
+        ParseGraphRecordChunk(content, table, progress, true);
+        progress.Report();
+        return;
+    }
+
+    // tokenize all chunks in parallel, the first chunk is parsed by the calling thread
+    std::vector<GraphRecordTable> chunkTables(chunks.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks.size(); ++i)
+    {
+        chunkTables[i].numMissingIds = 0;
+        workers.emplace_back(ParseGraphRecordChunk, chunks[i], std::ref(chunkTables[i]), std::ref(progress), false);
+    }
+    chunkTables[0].numMissingIds = 0;
+    ParseGraphRecordChunk(chunks[0], chunkTables[0], progress, true);
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+        progress.Report();
+    }
+
+    // concatenate the chunk results in file order
+    size_t numNodes = 0, numEdges = 0, numStrings = 0;
+    for (const GraphRecordTable &chunkTable : chunkTables)
+    {
+        numNodes += chunkTable.nodes.size();
+        numEdges += chunkTable.edges.size();
+        numStrings += chunkTable.strings.size();
+    }
+    table.nodes.reserve(numNodes);
+    table.edges.reserve(numEdges);
+    table.strings.reserve(numStrings);
+
+    for (GraphRecordTable &chunkTable : chunkTables)
+    {
+        uint32_t stringOffset = table.strings.size();
+        for (GraphRecordEntry &entry : chunkTable.nodes)
+        {
+            entry.firstString += stringOffset;
+            table.nodes.push_back(entry);
+        }
+        for (GraphRecordEntry &entry : chunkTable.edges)
+        {
+            entry.firstString += stringOffset;
+            table.edges.push_back(entry);
+        }
+        table.strings.insert(table.strings.end(), chunkTable.strings.begin(), chunkTable.strings.end());
+        table.numMissingIds += chunkTable.numMissingIds;
+    }
+}
+
+bool FindGraphNodeRecord(std::string_view content, int id, GraphRecord &record)
+{
+    while (!content.empty())
+    {
+        size_t posLineEnd = content.find('\n');
+        std::string_view lineStr = content.substr(0, posLineEnd);
+        content.remove_prefix(posLineEnd == std::string_view::npos ? content.size() : posLineEnd + 1);
+
+        ParseGraphRecord(lineStr, record);
+        if (record.type == RecordType::Node && record.hasId && record.id == id)
+            return true;
+    }
+
+    return false;
+}
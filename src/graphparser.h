@@ -0,0 +1,87 @@
+#ifndef GRAPHPARSER_H_
+#define GRAPHPARSER_H_
+
+#include <vector>
+#include <functional>
+#include <string_view>
+#include <cstdint>
+
+// token types of the answer graph file format, e.g. <TYPE:NODE><ID:1><ANSWER:Hello>
+enum class TokenType
+{
+    Type,
+    Id,
+    Answer,
+    Parent,
+    Child,
+    Keyword,
+    Unknown
+};
+
+// element described by a line of the answer graph file
+enum class RecordType
+{
+    None, // line without TYPE token (e.g. comment or empty line)
+    Node,
+    Edge,
+    Unknown
+};
+
+// all information contained in a single line of the answer graph file
+// strings are views into the parsed line, so they are only valid as long as the line itself
+struct GraphRecord
+{
+    RecordType type;
+    bool hasId;
+    bool hasParent;
+    bool hasChild;
+    int id;
+    int parentId;
+    int childId;
+    std::vector<std::string_view> answers;
+    std::vector<std::string_view> keywords;
+};
+
+// compact form of a node or edge record inside a GraphRecordTable
+struct GraphRecordEntry
+{
+    int id;
+    int parentId;
+    int childId;
+    bool hasParent;
+    bool hasChild;
+    uint32_t firstString; // answers (nodes) or keywords (edges) in GraphRecordTable::strings
+    uint32_t numStrings;
+};
+
+// all node and edge records of an answer graph file, both in file order
+// strings are views into the file content
+struct GraphRecordTable
+{
+    std::vector<GraphRecordEntry> nodes;
+    std::vector<GraphRecordEntry> edges;
+    std::vector<std::string_view> strings;
+    size_t numMissingIds; // lines with a TYPE but without an ID token
+};
+
+// classify the type of a token by its name (the part before the colon)
+TokenType GetTokenType(std::string_view name);
+
+// extract all tokens of a line in a single pass and store them in record
+// record is overwritten but its vectors keep their capacity, so reusing it for every line avoids allocations
+void ParseGraphRecord(std::string_view line, GraphRecord &record);
+
+// called by ParseGraphRecords with the share of the content parsed so far (between 0 and 1)
+typedef std::function<void(float share)> ParseProgressCallback;
+
+// parse the complete content of an answer graph file
+// large files are split into line-aligned chunks which are tokenized by up to numThreads worker threads,
+// the resulting table is the same for any number of threads
+// progress is reported from the calling thread only, while it parses its own chunk and whenever another chunk is done
+void ParseGraphRecords(std::string_view content, unsigned int numThreads, GraphRecordTable &table, const ParseProgressCallback &progressCallback = nullptr);
+
+// scan content for the first node record with the given ID, stopping as soon as it is found
+// this is the record ParseGraphRecords would use for that node, found without tokenizing the rest of the file
+bool FindGraphNodeRecord(std::string_view content, int id, GraphRecord &record);
+
+#endif /* GRAPHPARSER_H_ */
@@ -0,0 +1,18 @@
+#include "answergraph.h"
+#include "graphpublisher.h"
+
+GraphPublisher::GraphPublisher() : _version(0)
+{
+}
+
+std::shared_ptr<const AnswerGraph> GraphPublisher::GetGraph() const
+{
+    return std::atomic_load(&_graph);
+}
+
+void GraphPublisher::Publish(std::shared_ptr<const AnswerGraph> graph)
+{
+    // the graph is stored before the version is incremented, so a reader which sees the new version also gets the new graph
+    std::atomic_store(&_graph, std::move(graph));
+    _version.fetch_add(1, std::memory_order_release);
+}
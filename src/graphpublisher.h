@@ -0,0 +1,35 @@
+#ifndef GRAPHPUBLISHER_H_
+#define GRAPHPUBLISHER_H_
+
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+class AnswerGraph; // forward declaration
+
+// the current version of an answer graph, which can be replaced while sessions are using the previous one
+// a new graph is built completely before it is published, so readers never see a partially loaded graph
+// sessions which follow a publisher switch over the next time they enter the root node (see ChatSession),
+// an old graph is released as soon as the last session has left it
+class GraphPublisher
+{
+private:
+    // data handles (shared)
+    std::shared_ptr<const AnswerGraph> _graph; // only accessed through std::atomic_load / std::atomic_store
+
+    // proprietary members
+    std::atomic<uint64_t> _version; // incremented after every publication, so readers can check for changes cheaply
+
+public:
+    // constructor / destructor
+    GraphPublisher();
+
+    // getter / setter
+    uint64_t GetVersion() const { return _version.load(std::memory_order_acquire); }
+    std::shared_ptr<const AnswerGraph> GetGraph() const;
+
+    // proprietary functions
+    void Publish(std::shared_ptr<const AnswerGraph> graph); // may be called from any thread
+};
+
+#endif /* GRAPHPUBLISHER_H_ */
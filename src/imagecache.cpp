@@ -0,0 +1,68 @@
+#include <unordered_map>
+#include <mutex>
+#include <future>
+#include "imagecache.h"
+
+// state shared by all functions of ImageCache
+static std::mutex cacheMutex;
+static std::unordered_map<std::string, std::shared_future<wxImage>> preloadedImages; // taken out by the first user
+static std::unordered_map<std::string, std::weak_ptr<const wxBitmap>> cachedBitmaps;
+
+void ImageCache::Preload(const std::vector<std::string> &filenames)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    for (const std::string &filename : filenames)
+    {
+        if (preloadedImages.find(filename) != preloadedImages.end())
+            continue;
+
+        // decoding does not touch any GUI resources, so it may run on a worker thread
+        preloadedImages.emplace(filename, std::async(std::launch::async, [filename]() {
+            wxImage image;
+            image.LoadFile(filename, wxBITMAP_TYPE_ANY);
+            return image;
+        }));
+    }
+}
+
+wxImage ImageCache::GetImage(const std::string &filename, wxBitmapType type)
+{
+    std::shared_future<wxImage> preloaded;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = preloadedImages.find(filename);
+        if (it != preloadedImages.end())
+        {
+            preloaded = it->second;
+            preloadedImages.erase(it);
+        }
+    }
+
+    // wait for the worker outside of the lock, so other files can be requested in the meantime
+    if (preloaded.valid())
+        return preloaded.get();
+
+    wxImage image;
+    image.LoadFile(filename, type);
+    return image;
+}
+
+std::shared_ptr<const wxBitmap> ImageCache::GetBitmap(const std::string &filename, wxBitmapType type)
+{
+    // hand out the cached bitmap as long as it is still in use
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        std::shared_ptr<const wxBitmap> bitmap = cachedBitmaps[filename].lock();
+        if (bitmap != nullptr)
+            return bitmap;
+    }
+
+    // convert the (pre)loaded image, an image which could not be loaded results in an invalid bitmap
+    wxImage image = GetImage(filename, type);
+    std::shared_ptr<const wxBitmap> bitmap = image.IsOk() ? std::make_shared<const wxBitmap>(image) : std::make_shared<const wxBitmap>();
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cachedBitmaps[filename] = bitmap;
+    return bitmap;
+}
@@ -0,0 +1,25 @@
+#ifndef IMAGECACHE_H_
+#define IMAGECACHE_H_
+
+#include <wx/bitmap.h>
+#include <wx/image.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+// process-wide cache of decoded images
+// every file is decoded once, all callers share the resulting bitmap through reference-counted handles
+// the cache itself only holds weak references, so a bitmap is released as soon as nobody uses it anymore
+// (releasing bitmaps during static destruction, i.e. after wxWidgets has shut down, would not be safe)
+class ImageCache
+{
+public:
+    // proprietary functions
+    // Preload decodes the files on worker threads and returns immediately, the decoded images are picked up
+    // by the first GetImage / GetBitmap call for each file (bitmaps themselves have to be created on the main thread)
+    static void Preload(const std::vector<std::string> &filenames);
+    static wxImage GetImage(const std::string &filename, wxBitmapType type = wxBITMAP_TYPE_ANY);
+    static std::shared_ptr<const wxBitmap> GetBitmap(const std::string &filename, wxBitmapType type = wxBITMAP_TYPE_PNG);
+};
+
+#endif /* IMAGECACHE_H_ */
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include "levenshtein.h"
+#include "metrics.h"
+#include "keywordindex.h"
+
+KeywordIndex::KeywordIndex(const ImageKeyword *entries, size_t numEntries, const char *strings, const GraphEdge *edges)
+{
+    _entries = entries;
+    _numEntries = numEntries;
+    _strings = strings;
+    _edges = edges;
+}
+
+KeywordMatch KeywordIndex::FindBestMatch(std::string_view query) const
+{
+    KeywordMatch best{nullptr, unboundedDistance};
+    LevenshteinPattern pattern(query);
+
+    // keywords are scored in small batches so the distance engine can use its SIMD lanes
+    // the best distance found so far is passed as a bound: queries longer than 64 characters are scored one by one and
+    // stop comparisons which cannot win early, the SIMD kernels for shorter queries compute exact distances which are
+    // only capped by the bound (the scan itself stops as soon as an exact match is found)
+    const size_t batchSize = 8;
+    std::string_view keywords[batchSize];
+    int dists[batchSize];
+
+    size_t numScored = 0;
+    for (size_t first = 0; first < _numEntries && best.distance > 0; first += batchSize)
+    {
+        size_t count = std::min(batchSize, _numEntries - first);
+        numScored += count;
+        for (size_t i = 0; i < count; ++i)
+            keywords[i] = GetKeywordAtIndex(first + i);
+
+        pattern.ComputeDistances(keywords, count, dists, best.distance - 1);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (dists[i] < best.distance)
+            {
+                best.edge = GetEdgeAtIndex(first + i);
+                best.distance = dists[i];
+            }
+        }
+    }
+
+    if (IsMetricsEnabled())
+    {
+        RecordInHistogramSlot(MetricHistogram::MatchCandidates, numScored);
+        AddToCounterSlot(MetricCounter::KeywordsScored, numScored);
+    }
+    return best;
+}
+
+void KeywordIndex::FindBestMatches(std::string_view query, size_t k, std::vector<KeywordMatch> &matches) const
+{
+    matches.clear();
+    if (k == 0)
+        return;
+
+    // bounded max-heap of the k best candidates so far, the worst one (largest distance, latest position) is at the front
+    // the scratch buffer is reused between queries to avoid heap allocations
+    struct Candidate
+    {
+        int distance;
+        size_t position; // index of the first keyword of the edge
+    };
+    auto isCloser = [](const Candidate &a, const Candidate &b) { return a.distance < b.distance || (a.distance == b.distance && a.position < b.position); };
+    thread_local std::vector<Candidate> candidates;
+    candidates.clear();
+
+    LevenshteinPattern pattern(query);
+    size_t numScored = 0;
+    size_t i = 0;
+    while (i < _numEntries)
+    {
+        // edges are visited in index order, so an edge has to be strictly closer than the worst candidate of a full heap
+        size_t position = i;
+        uint32_t edge = _entries[i].edge;
+        int bound = candidates.size() < k ? unboundedDistance : candidates.front().distance - 1;
+
+        // score the edge by its closest keyword
+        int edgeDist = unboundedDistance;
+        for (; i < _numEntries && _entries[i].edge == edge; ++i)
+        {
+            edgeDist = std::min(edgeDist, pattern.ComputeDistance(GetKeywordAtIndex(i), std::min(bound, edgeDist - 1)));
+            ++numScored;
+        }
+
+        if (edgeDist > bound)
+            continue;
+
+        if (candidates.size() == k)
+        {
+            std::pop_heap(candidates.begin(), candidates.end(), isCloser);
+            candidates.pop_back();
+        }
+        candidates.push_back(Candidate{edgeDist, position});
+        std::push_heap(candidates.begin(), candidates.end(), isCloser);
+    }
+
+    // the ordering is strict (positions are unique), so the result does not depend on the heap implementation
+    std::sort_heap(candidates.begin(), candidates.end(), isCloser);
+    for (const Candidate &candidate : candidates)
+        matches.push_back(KeywordMatch{GetEdgeAtIndex(candidate.position), candidate.distance});
+
+    if (IsMetricsEnabled())
+    {
+        RecordInHistogramSlot(MetricHistogram::MatchCandidates, numScored);
+        AddToCounterSlot(MetricCounter::KeywordsScored, numScored);
+    }
+}
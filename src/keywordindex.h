@@ -0,0 +1,46 @@
+#ifndef KEYWORDINDEX_H_
+#define KEYWORDINDEX_H_
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include "graphimage.h"
+
+// result of matching a query against the keywords of a node
+struct KeywordMatch
+{
+    const GraphEdge *edge; // best matching edge (nullptr if there was nothing to match against)
+    int distance;          // Levenshtein distance between the query and the closest keyword of edge
+};
+
+// view of the normalized keyword table of a node (see GraphImage)
+// keywords have been converted to upper-case when the graph was built, so matching can compare them directly
+// all keywords of an edge are stored in a row, so each edge occupies a contiguous range of entries
+class KeywordIndex
+{
+private:
+    // data handles (not owned)
+    const ImageKeyword *_entries;
+    size_t _numEntries;
+    const char *_strings;    // string pool the keywords refer to
+    const GraphEdge *_edges; // edge table the entries refer to
+
+public:
+    // constructor / destructor
+    KeywordIndex(const ImageKeyword *entries, size_t numEntries, const char *strings, const GraphEdge *edges);
+
+    // getter / setter
+    size_t GetNumberOfKeywords() const { return _numEntries; }
+    std::string_view GetKeywordAtIndex(size_t index) const { return std::string_view(_strings + _entries[index].keyword.offset, _entries[index].keyword.length); }
+    const GraphEdge *GetEdgeAtIndex(size_t index) const { return _edges + _entries[index].edge; }
+
+    // matching (query has to be converted to upper-case by the caller)
+    // FindBestMatch returns the closest edge in a single pass without storing any candidates, the first of equally close keywords wins
+    // FindBestMatches stores the (at most) k closest edges in ascending order of distance, each edge is reported once and
+    // equally close edges are ordered by their position in the index, so matches[0] is the result of FindBestMatch
+    KeywordMatch FindBestMatch(std::string_view query) const;
+    void FindBestMatches(std::string_view query, size_t k, std::vector<KeywordMatch> &matches) const;
+};
+
+#endif /* KEYWORDINDEX_H_ */
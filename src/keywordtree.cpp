@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <memory>
+#include <cstdlib>
+#include "levenshtein.h"
+#include "metrics.h"
+#include "memoryusage.h"
+#include "keywordtree.h"
+
+void KeywordTree::Build(const KeywordIndex &index)
+{
+    _nodes.clear();
+    _keywords.clear();
+    if (index.GetNumberOfKeywords() == 0)
+        return;
+
+    // insert all keywords into a linked tree first (children are found by their distance to the parent)
+    struct BuildNode
+    {
+        uint32_t keyword;
+        uint32_t distance;
+        std::vector<std::unique_ptr<BuildNode>> children;
+    };
+    BuildNode root{0, 0, {}};
+    for (uint32_t keyword = 1; keyword < index.GetNumberOfKeywords(); ++keyword)
+    {
+        LevenshteinPattern pattern(index.GetKeywordAtIndex(keyword));
+        BuildNode *node = &root;
+        while (true)
+        {
+            uint32_t distance = pattern.ComputeDistance(index.GetKeywordAtIndex(node->keyword));
+            auto child = std::find_if(node->children.begin(), node->children.end(),
+                                      [distance](const std::unique_ptr<BuildNode> &c) { return c->distance == distance; });
+            if (child == node->children.end())
+            {
+                node->children.emplace_back(new BuildNode{keyword, distance, {}});
+                break;
+            }
+            node = child->get();
+        }
+    }
+
+    // flatten the tree in breadth-first order, so the children of every node are stored in a row
+    _nodes.reserve(index.GetNumberOfKeywords());
+    std::vector<BuildNode *> queue{&root};
+    auto addNode = [this, &index](uint32_t keyword, uint32_t distance) {
+        std::string_view str = index.GetKeywordAtIndex(keyword);
+        _nodes.push_back(TreeNode{keyword, distance, 0, 0, static_cast<uint32_t>(_keywords.size()), static_cast<uint32_t>(str.size())});
+        _keywords.append(str);
+    };
+    addNode(root.keyword, 0);
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        BuildNode *node = queue[i];
+        std::sort(node->children.begin(), node->children.end(),
+                  [](const std::unique_ptr<BuildNode> &a, const std::unique_ptr<BuildNode> &b) { return a->distance < b->distance; });
+
+        _nodes[i].firstChild = _nodes.size();
+        _nodes[i].numChildren = node->children.size();
+        for (std::unique_ptr<BuildNode> &child : node->children)
+        {
+            addNode(child->keyword, child->distance);
+            queue.push_back(child.get());
+        }
+    }
+}
+
+size_t KeywordTree::GetMemoryUsage() const
+{
+    return GetHeapMemoryUsage(_nodes) + GetHeapMemoryUsage(_keywords);
+}
+
+KeywordMatch KeywordTree::FindBestMatch(const KeywordIndex &index, const LevenshteinPattern &pattern) const
+{
+    KeywordMatch best{nullptr, unboundedDistance};
+    if (_nodes.empty())
+        return best;
+
+    // depth-first search over the nodes still to be visited, together with the lower bound for the distance of all
+    // keywords in their subtree (a stack keeps the bookkeeping cheaper than a priority queue)
+    struct Candidate
+    {
+        uint32_t node;
+        int lowerBound;
+    };
+    thread_local std::vector<Candidate> stack;
+    stack.clear();
+    stack.push_back(Candidate{0, 0});
+
+    uint32_t bestKeyword = 0;
+    size_t numScored = 0;
+    while (!stack.empty())
+    {
+        Candidate candidate = stack.back();
+        stack.pop_back();
+
+        // the best distance may have dropped since the candidate was pushed
+        // (keywords with equal distance still count, as the keyword which comes first in the index wins)
+        if (candidate.lowerBound > best.distance)
+            continue;
+
+        // the exact distance is only needed as long as it can lead to a better keyword or a child subtree
+        const TreeNode &node = _nodes[candidate.node];
+        int maxChildDistance = node.numChildren > 0 ? _nodes[node.firstChild + node.numChildren - 1].distance : 0;
+        int bound = best.distance > unboundedDistance - maxChildDistance ? unboundedDistance : best.distance + maxChildDistance;
+        int distance = pattern.ComputeDistance(std::string_view(_keywords).substr(node.offset, node.length), bound);
+        ++numScored;
+        if (distance > bound)
+            continue;
+
+        if (distance < best.distance || (distance == best.distance && node.keyword < bestKeyword))
+        {
+            best.edge = index.GetEdgeAtIndex(node.keyword);
+            best.distance = distance;
+            bestKeyword = node.keyword;
+        }
+
+        // push the children whose subtree can contain keywords within the best distance, the most promising last
+        // (children are sorted by distance, so the farthest remaining child is always at one of both ends)
+        uint32_t first = node.firstChild;
+        uint32_t last = node.firstChild + node.numChildren;
+        while (first < last)
+        {
+            int lowerBoundFirst = std::abs(distance - static_cast<int>(_nodes[first].distance));
+            int lowerBoundLast = std::abs(distance - static_cast<int>(_nodes[last - 1].distance));
+            Candidate child = lowerBoundFirst >= lowerBoundLast ? Candidate{first++, lowerBoundFirst} : Candidate{--last, lowerBoundLast};
+            if (child.lowerBound <= best.distance)
+                stack.push_back(child);
+        }
+    }
+
+    if (IsMetricsEnabled())
+    {
+        RecordInHistogramSlot(MetricHistogram::MatchCandidates, numScored);
+        AddToCounterSlot(MetricCounter::KeywordsScored, numScored);
+    }
+    return best;
+}
@@ -0,0 +1,48 @@
+#ifndef KEYWORDTREE_H_
+#define KEYWORDTREE_H_
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include "keywordindex.h"
+
+class LevenshteinPattern; // forward declaration
+
+// BK-tree over the keywords of a KeywordIndex, for nodes with so many keywords that scoring all of them is too slow
+// every subtree of a tree node only contains keywords with the same distance to that node, so by the triangle inequality
+// a search can skip all subtrees whose distance range cannot contain a keyword closer than the best one found so far
+// this pays off for queries close to one of the keywords (e.g. typos), queries far away from all keywords still visit most nodes
+// tree nodes are stored in breadth-first order with the children of each node sorted by distance
+class KeywordTree
+{
+private:
+    // proprietary type definitions
+    struct TreeNode
+    {
+        uint32_t keyword;    // index into the KeywordIndex
+        uint32_t distance;   // Levenshtein distance to the parent node
+        uint32_t firstChild; // index into _nodes
+        uint32_t numChildren;
+        uint32_t offset; // copy of the keyword inside _keywords
+        uint32_t length;
+    };
+
+    // proprietary members
+    std::vector<TreeNode> _nodes; // _nodes[0] is the root if the tree is not empty
+    std::string _keywords;        // keywords in tree order, so a search does not jump around the string pool
+
+public:
+    // getter / setter
+    size_t GetNumberOfNodes() const { return _nodes.size(); }
+    size_t GetMemoryUsage() const; // heap bytes
+
+    // proprietary functions
+    void Build(const KeywordIndex &index);
+
+    // same result as index.FindBestMatch (including the choice between keywords with equal distance),
+    // pattern has to be the normalized query
+    KeywordMatch FindBestMatch(const KeywordIndex &index, const LevenshteinPattern &pattern) const;
+};
+
+#endif /* KEYWORDTREE_H_ */
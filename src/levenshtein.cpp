@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <vector>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LEVENSHTEIN_HAS_AVX2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LEVENSHTEIN_HAS_NEON
+#endif
+#include "levenshtein.h"
+
+// maximum pattern length for the bit-parallel algorithm
+const size_t wordBits = 64;
+
+// kernel which computes the exact distances between one bit-parallel pattern and several texts
+typedef void (*BitParallelBatchKernel)(const uint64_t *peq, size_t m, const std::string_view *texts, size_t count, int *distances);
+
+void ToUpperCase(std::string_view source, std::string &target)
+{
+    target.resize(source.size());
+    std::transform(source.begin(), source.end(), target.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+}
+
+// largest distance which has to be computed exactly
+// the distance can never exceed the length of the longer string, so there is no need to look any further
+static size_t GetDistanceBound(size_t m, size_t n, int maxDistance)
+{
+    size_t k = std::max(m, n);
+    if (maxDistance < 0)
+        maxDistance = 0;
+    if (static_cast<size_t>(maxDistance) < k)
+        k = maxDistance;
+    return k;
+}
+
+// bit-parallel distance computation (Myers 1999, Hyyrö 2001) for patterns of 1 to 64 characters
+// bit i of pv / mv is set if the cost in row i + 1 of the current column is one higher / lower than in row i
+static size_t ComputeBitParallelDistance(const uint64_t *peq, size_t m, std::string_view text, size_t k)
+{
+    const uint64_t last = uint64_t(1) << (m - 1);
+    const size_t n = text.size();
+
+    uint64_t pv = ~uint64_t(0);
+    uint64_t mv = 0;
+    size_t score = m;
+
+    for (size_t j = 0; j < n; ++j)
+    {
+        uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+
+        if (ph & last)
+            ++score;
+        else if (mh & last)
+            --score;
+
+        // each of the remaining characters can lower the score by at most one
+        if (score > k + (n - j - 1))
+            return k + 1;
+
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+
+    return std::min(score, k + 1);
+}
+
+// scalar dynamic programming for strings which do not fit into a machine word
+// only the diagonal band |i - j| <= k can contain cells with a cost <= k (Ukkonen)
+static size_t ComputeBandedDistance(std::string_view s1, std::string_view s2, size_t k)
+{
+    const size_t m(s1.size());
+    const size_t n(s2.size());
+    const size_t outOfBand = k + 1; // cost of all cells which cannot lead to a distance <= k
+
+    // scratch row for the cost matrix, reused between calls to avoid a heap allocation per comparison
+    thread_local std::vector<size_t> costs;
+    costs.resize(n + 1);
+
+    for (size_t j = 0; j <= n; ++j)
+        costs[j] = j <= k ? j : outOfBand;
+
+    for (size_t i = 1; i <= m; ++i)
+    {
+        const size_t first = i > k ? i - k : 1;
+        const size_t last = std::min(n, i + k);
+
+        size_t corner = costs[first - 1];
+        costs[first - 1] = first == 1 ? i : outOfBand;
+        size_t rowMin = costs[first - 1];
+
+        const char c1 = s1[i - 1];
+        for (size_t j = first; j <= last; ++j)
+        {
+            size_t upper = costs[j];
+            size_t cost;
+            if (c1 == s2[j - 1])
+            {
+                cost = corner;
+            }
+            else
+            {
+                size_t t(upper < corner ? upper : corner);
+                cost = (costs[j - 1] < t ? costs[j - 1] : t) + 1;
+                if (cost > outOfBand)
+                    cost = outOfBand;
+            }
+
+            costs[j] = cost;
+            rowMin = std::min(rowMin, cost);
+            corner = upper;
+        }
+
+        // costs never decrease along a diagonal, so once a whole row exceeds the bound the result will as well
+        if (rowMin > k)
+            return outOfBand;
+    }
+
+    return std::min(costs[n], outOfBand);
+}
+
+static void ComputeBitParallelDistancesScalar(const uint64_t *peq, size_t m, const std::string_view *texts, size_t count, int *distances)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        distances[i] = static_cast<int>(ComputeBitParallelDistance(peq, m, texts[i], std::max(m, texts[i].size())));
+    }
+}
+
+#if defined(LEVENSHTEIN_HAS_AVX2)
+// four texts are processed in parallel, one per 64-bit lane
+// lanes whose text has been consumed completely keep their score while the longest text is finished
+__attribute__((target("avx2"))) static void ComputeBitParallelDistancesAVX2(const uint64_t *peq, size_t m, const std::string_view *texts, size_t count, int *distances)
+{
+    const __m256i last = _mm256_set1_epi64x(static_cast<long long>(uint64_t(1) << (m - 1)));
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i one = _mm256_set1_epi64x(1);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const std::string_view *t = texts + i;
+        const size_t maxLength = std::max(std::max(t[0].size(), t[1].size()), std::max(t[2].size(), t[3].size()));
+        const __m256i lengths = _mm256_set_epi64x(t[3].size(), t[2].size(), t[1].size(), t[0].size());
+
+        __m256i pv = ones;
+        __m256i mv = _mm256_setzero_si256();
+        __m256i score = _mm256_set1_epi64x(m);
+
+        for (size_t j = 0; j < maxLength; ++j)
+        {
+            const __m256i active = _mm256_cmpgt_epi64(lengths, _mm256_set1_epi64x(j));
+            const __m256i eq = _mm256_set_epi64x(j < t[3].size() ? peq[static_cast<unsigned char>(t[3][j])] : 0,
+                                                 j < t[2].size() ? peq[static_cast<unsigned char>(t[2][j])] : 0,
+                                                 j < t[1].size() ? peq[static_cast<unsigned char>(t[1][j])] : 0,
+                                                 j < t[0].size() ? peq[static_cast<unsigned char>(t[0][j])] : 0);
+
+            __m256i xv = _mm256_or_si256(eq, mv);
+            __m256i xh = _mm256_or_si256(_mm256_xor_si256(_mm256_add_epi64(_mm256_and_si256(eq, pv), pv), pv), eq);
+            __m256i ph = _mm256_or_si256(mv, _mm256_andnot_si256(_mm256_or_si256(xh, pv), ones));
+            __m256i mh = _mm256_and_si256(pv, xh);
+
+            // comparison results are -1 in lanes where the last bit is set
+            __m256i phHit = _mm256_and_si256(_mm256_cmpeq_epi64(_mm256_and_si256(ph, last), last), active);
+            __m256i mhHit = _mm256_and_si256(_mm256_cmpeq_epi64(_mm256_and_si256(mh, last), last), active);
+            score = _mm256_add_epi64(_mm256_sub_epi64(score, phHit), mhHit);
+
+            ph = _mm256_or_si256(_mm256_slli_epi64(ph, 1), one);
+            mh = _mm256_slli_epi64(mh, 1);
+            pv = _mm256_or_si256(mh, _mm256_andnot_si256(_mm256_or_si256(xv, ph), ones));
+            mv = _mm256_and_si256(ph, xv);
+        }
+
+        alignas(32) long long scores[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(scores), score);
+        for (size_t lane = 0; lane < 4; ++lane)
+            distances[i + lane] = static_cast<int>(scores[lane]);
+    }
+
+    ComputeBitParallelDistancesScalar(peq, m, texts + i, count - i, distances + i);
+}
+#endif
+
+#if defined(LEVENSHTEIN_HAS_NEON)
+// two texts are processed in parallel, one per 64-bit lane (see AVX2 variant)
+static void ComputeBitParallelDistancesNEON(const uint64_t *peq, size_t m, const std::string_view *texts, size_t count, int *distances)
+{
+    const uint64x2_t last = vdupq_n_u64(uint64_t(1) << (m - 1));
+    const uint64x2_t one = vdupq_n_u64(1);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        const std::string_view *t = texts + i;
+        const size_t maxLength = std::max(t[0].size(), t[1].size());
+        const uint64_t lengthValues[2] = {t[0].size(), t[1].size()};
+        const uint64x2_t lengths = vld1q_u64(lengthValues);
+
+        uint64x2_t pv = vdupq_n_u64(~uint64_t(0));
+        uint64x2_t mv = vdupq_n_u64(0);
+        int64x2_t score = vdupq_n_s64(static_cast<int64_t>(m));
+
+        for (size_t j = 0; j < maxLength; ++j)
+        {
+            const uint64x2_t active = vcgtq_u64(lengths, vdupq_n_u64(j));
+            const uint64_t eqValues[2] = {j < t[0].size() ? peq[static_cast<unsigned char>(t[0][j])] : 0,
+                                          j < t[1].size() ? peq[static_cast<unsigned char>(t[1][j])] : 0};
+            const uint64x2_t eq = vld1q_u64(eqValues);
+
+            uint64x2_t xv = vorrq_u64(eq, mv);
+            uint64x2_t xh = vorrq_u64(veorq_u64(vaddq_u64(vandq_u64(eq, pv), pv), pv), eq);
+            uint64x2_t ph = vornq_u64(mv, vorrq_u64(xh, pv));
+            uint64x2_t mh = vandq_u64(pv, xh);
+
+            // test results are all ones (= -1) in lanes where the last bit is set
+            uint64x2_t phHit = vandq_u64(vtstq_u64(ph, last), active);
+            uint64x2_t mhHit = vandq_u64(vtstq_u64(mh, last), active);
+            score = vaddq_s64(vsubq_s64(score, vreinterpretq_s64_u64(phHit)), vreinterpretq_s64_u64(mhHit));
+
+            ph = vorrq_u64(vshlq_n_u64(ph, 1), one);
+            mh = vshlq_n_u64(mh, 1);
+            pv = vornq_u64(mh, vorrq_u64(xv, ph));
+            mv = vandq_u64(ph, xv);
+        }
+
+        distances[i] = static_cast<int>(vgetq_lane_s64(score, 0));
+        distances[i + 1] = static_cast<int>(vgetq_lane_s64(score, 1));
+    }
+
+    ComputeBitParallelDistancesScalar(peq, m, texts + i, count - i, distances + i);
+}
+#endif
+
+// pick the widest kernel supported by the CPU the program is running on
+static BitParallelBatchKernel SelectBitParallelBatchKernel()
+{
+#if defined(LEVENSHTEIN_HAS_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+        return ComputeBitParallelDistancesAVX2;
+#elif defined(LEVENSHTEIN_HAS_NEON)
+    return ComputeBitParallelDistancesNEON;
+#endif
+    return ComputeBitParallelDistancesScalar;
+}
+
+int ComputeLevenshteinDistance(std::string_view s1, std::string_view s2, int maxDistance)
+{
+    const size_t m(s1.size());
+    const size_t n(s2.size());
+    const size_t k = GetDistanceBound(m, n, maxDistance);
+
+    // the length difference is a lower bound of the distance
+    if ((m > n ? m - n : n - m) > k)
+        return static_cast<int>(k + 1);
+
+    if (m == 0)
+        return static_cast<int>(n);
+    if (n == 0)
+        return static_cast<int>(m);
+
+    // use the shorter string as pattern so it is more likely to fit into a machine word
+    std::string_view pattern = m <= n ? s1 : s2;
+    std::string_view text = m <= n ? s2 : s1;
+    if (pattern.size() <= wordBits)
+    {
+        // match masks are reset after use, so only the characters of the pattern have to be touched
+        thread_local uint64_t peq[256] = {};
+        for (size_t j = 0; j < pattern.size(); ++j)
+            peq[static_cast<unsigned char>(pattern[j])] |= uint64_t(1) << j;
+
+        size_t dist = ComputeBitParallelDistance(peq, pattern.size(), text, k);
+
+        for (char c : pattern)
+            peq[static_cast<unsigned char>(c)] = 0;
+
+        return static_cast<int>(dist);
+    }
+
+    return static_cast<int>(ComputeBandedDistance(s1, s2, k));
+}
+
+LevenshteinPattern::LevenshteinPattern(std::string_view pattern) : _pattern(pattern)
+{
+    std::memset(_peq, 0, sizeof(_peq));
+    if (IsBitParallel())
+    {
+        for (size_t j = 0; j < _pattern.size(); ++j)
+            _peq[static_cast<unsigned char>(_pattern[j])] |= uint64_t(1) << j;
+    }
+}
+
+int LevenshteinPattern::ComputeDistance(std::string_view text, int maxDistance) const
+{
+    if (!IsBitParallel() || _pattern.empty() || text.empty())
+        return ComputeLevenshteinDistance(_pattern, text, maxDistance);
+
+    const size_t m(_pattern.size());
+    const size_t n(text.size());
+    const size_t k = GetDistanceBound(m, n, maxDistance);
+
+    if ((m > n ? m - n : n - m) > k)
+        return static_cast<int>(k + 1);
+
+    return static_cast<int>(ComputeBitParallelDistance(_peq, m, text, k));
+}
+
+void LevenshteinPattern::ComputeDistances(const std::string_view *texts, size_t count, int *distances, int maxDistance) const
+{
+    if (!IsBitParallel() || _pattern.empty())
+    {
+        for (size_t i = 0; i < count; ++i)
+            distances[i] = ComputeDistance(texts[i], maxDistance);
+        return;
+    }
+
+    // the SIMD kernels have no early cutoff, so the bound is applied to their exact results
+    static const BitParallelBatchKernel kernel = SelectBitParallelBatchKernel();
+    kernel(_peq, _pattern.size(), texts, count, distances);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t k = GetDistanceBound(_pattern.size(), texts[i].size(), maxDistance);
+        if (static_cast<size_t>(distances[i]) > k)
+            distances[i] = static_cast<int>(k + 1);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef LEVENSHTEIN_H_
+#define LEVENSHTEIN_H_
+
+#include <string>
+#include <string_view>
+#include <limits>
+#include <cstdint>
+
+// bound which disables the early cutoff of ComputeLevenshteinDistance
+const int unboundedDistance = std::numeric_limits<int>::max();
+
+// convert source to upper-case and store the result in target
+// target is overwritten but keeps its capacity, so a reused buffer does not allocate
+void ToUpperCase(std::string_view source, std::string &target);
+
+// compute the Levenshtein distance between two strings (comparison is case-sensitive, so normalize both strings first)
+// only distances up to maxDistance are computed exactly: as soon as the result is known to exceed maxDistance,
+// the computation stops and maxDistance + 1 is returned
+// if one of the strings fits into a machine word, the bit-parallel algorithm of Myers/Hyyrö is used,
+// otherwise a banded dynamic programming scheme (Ukkonen)
+int ComputeLevenshteinDistance(std::string_view s1, std::string_view s2, int maxDistance = unboundedDistance);
+
+// query which is compared against many strings (e.g. all keywords of a node)
+// the character match masks for the bit-parallel algorithm are computed once in the constructor,
+// so each comparison is O(length of the other string) as long as the pattern has at most 64 characters
+class LevenshteinPattern
+{
+private:
+    // proprietary members
+    std::string_view _pattern; // not owned, has to outlive this object
+    uint64_t _peq[256];        // bit j is set in _peq[c] if _pattern[j] == c
+
+public:
+    // constructor / destructor
+    explicit LevenshteinPattern(std::string_view pattern);
+
+    // getter / setter
+    bool IsBitParallel() const { return _pattern.size() <= 64; }
+
+    // proprietary functions
+    // both functions follow the bound semantics of ComputeLevenshteinDistance
+    // ComputeDistances scores several texts at once, using SIMD lanes (AVX2 / NEON) if the CPU supports them
+    int ComputeDistance(std::string_view text, int maxDistance = unboundedDistance) const;
+    void ComputeDistances(const std::string_view *texts, size_t count, int *distances, int maxDistance = unboundedDistance) const;
+};
+
+#endif /* LEVENSHTEIN_H_ */
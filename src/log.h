@@ -0,0 +1,40 @@
+#ifndef LOG_H_
+#define LOG_H_
+
+// opt-in trace logging for object lifecycles and other diagnostics which are too chatty for normal operation
+// tracing is enabled by defining MEMBOT_ENABLE_TRACE (cmake -DMEMBOT_TRACE=ON), otherwise TRACE_LOG expands to nothing
+// and its arguments are not even evaluated, so trace statements cost nothing in regular builds
+// usage: TRACE_LOG("ChatBot Constructor: Create object at " << this);
+
+#ifdef MEMBOT_ENABLE_TRACE
+
+#include <iostream>
+#include <sstream>
+#include <mutex>
+
+// writes one complete line to stderr, lines of concurrent threads are not interleaved
+inline void WriteTraceLine(const std::string &line)
+{
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::clog << line << '\n';
+}
+
+#define TRACE_LOG(message)                    \
+    do                                        \
+    {                                         \
+        std::ostringstream traceStream;       \
+        traceStream << message;               \
+        WriteTraceLine(traceStream.str());    \
+    } while (false)
+
+#else
+
+#define TRACE_LOG(message) \
+    do                     \
+    {                      \
+    } while (false)
+
+#endif
+
+#endif /* LOG_H_ */
@@ -0,0 +1,98 @@
+#include <fstream>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "mappedfile.h"
+
+MappedFile::MappedFile()
+{
+    _data = nullptr;
+    _size = 0;
+    _isOpen = false;
+    _isMapped = false;
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string &filename)
+{
+    Close();
+
+#if !defined(_WIN32)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    // an empty file cannot be mapped, but it is still a valid (empty) file
+    if (info.st_size > 0)
+    {
+        void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            // the content is usually parsed front to back, so let the kernel read ahead
+            madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+            _data = static_cast<const char *>(data);
+            _size = info.st_size;
+            _isMapped = true;
+        }
+    }
+
+    // the mapping stays valid after the file descriptor has been closed
+    close(fd);
+    if (_isMapped || info.st_size == 0)
+    {
+        _isOpen = true;
+        return true;
+    }
+#endif
+
+    // fall back to reading the whole file with a single call
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::streamsize size = file.tellg();
+    if (size < 0)
+        return false;
+    file.seekg(0, std::ios::beg);
+    _buffer.resize(size);
+    if (size > 0 && !file.read(_buffer.data(), size))
+    {
+        _buffer.clear();
+        return false;
+    }
+
+    _data = _buffer.data();
+    _size = _buffer.size();
+    _isOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+#if !defined(_WIN32)
+    if (_isMapped)
+        munmap(const_cast<char *>(_data), _size);
+#endif
+
+    _buffer.clear();
+    _buffer.shrink_to_fit();
+    _data = nullptr;
+    _size = 0;
+    _isOpen = false;
+    _isMapped = false;
+}
@@ -0,0 +1,37 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// read-only view of the complete content of a file
+// on POSIX systems the file is memory-mapped, elsewhere it is read into a buffer in one go
+// views into the content stay valid until the file is closed
+class MappedFile
+{
+private:
+    // data handles
+    const char *_data;
+    size_t _size;
+    bool _isOpen;
+    bool _isMapped;            // true if _data refers to a memory mapping which has to be released
+    std::vector<char> _buffer; // file content if memory mapping is not available
+
+public:
+    // constructor / destructor
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile &source) = delete;
+    MappedFile &operator=(const MappedFile &source) = delete;
+
+    // getter / setter
+    bool IsOpen() const { return _isOpen; }
+    std::string_view GetContent() const { return std::string_view(_data, _size); }
+
+    // proprietary functions
+    bool Open(const std::string &filename);
+    void Close();
+};
+
+#endif /* MAPPEDFILE_H_ */
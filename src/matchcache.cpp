@@ -0,0 +1,104 @@
+#include <iterator>
+#include "metrics.h"
+#include "memoryusage.h"
+#include "matchcache.h"
+
+MatchCache::MatchCache(size_t capacity) : _numHits(0), _numMisses(0)
+{
+    SetCapacity(capacity);
+}
+
+void MatchCache::SetCapacity(size_t capacity)
+{
+    Clear();
+    _shardCapacity = (capacity + numShards - 1) / numShards;
+
+    // the index never grows beyond the capacity, so it is never rehashed
+    for (Shard &shard : _shards)
+        shard.index.reserve(_shardCapacity);
+}
+
+size_t MatchCache::GetMemoryUsage() const
+{
+    size_t usage = 0;
+    for (const Shard &shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        usage += GetHeapMemoryUsage(shard.entries) + GetHeapMemoryUsage(shard.index);
+        for (const Entry &entry : shard.entries)
+            usage += GetHeapMemoryUsage(entry.message);
+    }
+    return usage;
+}
+
+bool MatchCache::Find(uint32_t node, std::string_view message, KeywordMatch &match)
+{
+    if (_shardCapacity == 0 || message.size() > maxCachedMessageLength)
+        return false;
+
+    Key key{node, message};
+    Shard &shard = GetShard(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto entry = shard.index.find(key);
+        if (entry != shard.index.end())
+        {
+            // move the entry to the front, so the least recently used entry is always at the back
+            shard.entries.splice(shard.entries.begin(), shard.entries, entry->second);
+            match = entry->second->match;
+            _numHits.fetch_add(1, std::memory_order_relaxed);
+            AddToCounter(MetricCounter::MatchCacheHits);
+            return true;
+        }
+    }
+
+    _numMisses.fetch_add(1, std::memory_order_relaxed);
+    AddToCounter(MetricCounter::MatchCacheMisses);
+    return false;
+}
+
+void MatchCache::Insert(uint32_t node, std::string_view message, const KeywordMatch &match)
+{
+    if (_shardCapacity == 0 || message.size() > maxCachedMessageLength)
+        return;
+
+    Shard &shard = GetShard(Key{node, message});
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // another thread may have inserted the same result in the meantime
+    if (shard.index.find(Key{node, message}) != shard.index.end())
+        return;
+
+    // a shard allocates until it is full, afterwards the evicted entry is reused with its list node, its message buffer
+    // (which has room for any cached message) and its index node, so inserting into a full cache does not allocate
+    if (shard.entries.size() >= _shardCapacity)
+    {
+        auto indexNode = shard.index.extract(Key{shard.entries.back().node, shard.entries.back().message});
+        shard.entries.splice(shard.entries.begin(), shard.entries, std::prev(shard.entries.end()));
+        Entry &entry = shard.entries.front();
+        entry.node = node;
+        entry.message.assign(message);
+        entry.match = match;
+        indexNode.key() = Key{node, entry.message};
+        shard.index.insert(std::move(indexNode)); // still refers to the entry, splicing keeps iterators valid
+    }
+    else
+    {
+        shard.entries.push_front(Entry{node, std::string(), match});
+        shard.entries.front().message.reserve(maxCachedMessageLength);
+        shard.entries.front().message.assign(message);
+        shard.index.emplace(Key{node, shard.entries.front().message}, shard.entries.begin());
+    }
+}
+
+void MatchCache::Clear()
+{
+    for (Shard &shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.entries.clear();
+    }
+    _numHits.store(0, std::memory_order_relaxed);
+    _numMisses.store(0, std::memory_order_relaxed);
+}
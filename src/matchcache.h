@@ -0,0 +1,82 @@
+#ifndef MATCHCACHE_H_
+#define MATCHCACHE_H_
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+#include "keywordindex.h"
+
+// number of entries cached by default, 0 disables the cache
+const size_t defaultMatchCacheCapacity = 4096;
+
+// longer messages are matched without the cache, so the memory used by the cache stays bounded
+const size_t maxCachedMessageLength = 256;
+
+// bounded LRU cache of match results keyed by (node index, normalized message)
+// traffic is very repetitive (e.g. "hi" or "pointers" at the same node), so a hit skips all distance computations
+// the cache is split into shards with a lock of their own, so concurrent sessions rarely wait for each other
+class MatchCache
+{
+private:
+    // proprietary type definitions
+    struct Entry
+    {
+        uint32_t node;
+        std::string message;
+        KeywordMatch match;
+    };
+
+    struct Key
+    {
+        uint32_t node;
+        std::string_view message; // refers to the message of the entry, or to the query during a lookup
+
+        bool operator==(const Key &other) const { return node == other.node && message == other.message; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const { return std::hash<std::string_view>()(key.message) ^ (key.node * 0x9E3779B97F4A7C15ull); }
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::list<Entry> entries; // most recently used first
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    };
+
+    static const size_t numShards = 16;
+
+    // proprietary members
+    Shard _shards[numShards];
+    size_t _shardCapacity;
+    std::atomic<uint64_t> _numHits;
+    std::atomic<uint64_t> _numMisses;
+
+    // proprietary functions
+    Shard &GetShard(const Key &key) { return _shards[KeyHash()(key) % numShards]; }
+
+public:
+    // constructor / destructor
+    explicit MatchCache(size_t capacity = defaultMatchCacheCapacity);
+
+    // getter / setter
+    uint64_t GetNumberOfHits() const { return _numHits.load(std::memory_order_relaxed); }
+    uint64_t GetNumberOfMisses() const { return _numMisses.load(std::memory_order_relaxed); }
+    size_t GetCapacity() const { return _shardCapacity * numShards; }
+    size_t GetMemoryUsage() const; // heap bytes of all entries
+    void SetCapacity(size_t capacity); // clears the cache, must not be called while other threads use the cache
+
+    // proprietary functions
+    // all functions may be called from any number of threads at once
+    bool Find(uint32_t node, std::string_view message, KeywordMatch &match);
+    void Insert(uint32_t node, std::string_view message, const KeywordMatch &match);
+    void Clear(); // also resets the counters
+};
+
+#endif /* MATCHCACHE_H_ */
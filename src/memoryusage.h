@@ -0,0 +1,39 @@
+#ifndef MEMORYUSAGE_H_
+#define MEMORYUSAGE_H_
+
+#include <vector>
+#include <list>
+#include <string>
+#include <utility>
+#include <unordered_map>
+#include <cstddef>
+
+// estimates of the heap memory held by standard containers, for the footprint reports of AnswerGraph
+// allocator bookkeeping is not included, node-based containers are assumed to need two pointers per element
+
+template <typename T>
+size_t GetHeapMemoryUsage(const std::vector<T> &container)
+{
+    return container.capacity() * sizeof(T);
+}
+
+inline size_t GetHeapMemoryUsage(const std::string &str)
+{
+    // short strings are stored inside the string object itself
+    return str.capacity() > std::string().capacity() ? str.capacity() + 1 : 0;
+}
+
+template <typename T>
+size_t GetHeapMemoryUsage(const std::list<T> &container)
+{
+    return container.size() * (sizeof(T) + 2 * sizeof(void *));
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t GetHeapMemoryUsage(const std::unordered_map<Key, Value, Hash> &container)
+{
+    // bucket array plus one node per element holding the element, the link to the next node and the cached hash
+    return container.bucket_count() * sizeof(void *) + container.size() * (sizeof(std::pair<const Key, Value>) + 2 * sizeof(void *));
+}
+
+#endif /* MEMORYUSAGE_H_ */
@@ -0,0 +1,200 @@
+#include <cmath>
+#include "metrics.h"
+
+// threads are spread over this many slots, threads sharing a slot still count correctly (just with some contention)
+const size_t numMetricSlots = 32;
+
+// bucket i holds the values in (2^(i-1), 2^i], so exact powers of two (e.g. full batches of keywords) are counted
+// below the bound they are equal to (bucket 0 holds zeros and ones)
+const size_t numHistogramBuckets = 48;
+
+const size_t numCounters = static_cast<size_t>(MetricCounter::NumCounters);
+const size_t numHistograms = static_cast<size_t>(MetricHistogram::NumHistograms);
+
+struct MetricInfo
+{
+    const char *name;
+    const char *help;
+    double scale; // factor from the recorded integer unit to the exported unit
+};
+
+static const MetricInfo counterInfos[numCounters] = {
+    {"membot_keywords_scored_total", "Keywords scored by all matching strategies", 1.0},
+    {"membot_match_cache_hits_total", "Messages answered from the match cache", 1.0},
+    {"membot_match_cache_misses_total", "Messages which had to be matched", 1.0},
+    {"membot_messages_sent_total", "Answers handed to a front-end", 1.0},
+};
+
+static const MetricInfo histogramInfos[numHistograms] = {
+    {"membot_load_map_file_seconds", "Time to map an answer graph file", 1e-9},
+    {"membot_load_tokenize_seconds", "Time to parse the lines of an answer graph file into records", 1e-9},
+    {"membot_load_link_seconds", "Time to resolve the node and edge IDs of an answer graph", 1e-9},
+    {"membot_load_root_detection_seconds", "Time to identify the root node of an answer graph", 1e-9},
+    {"membot_load_layout_seconds", "Time to lay out the tables of an answer graph", 1e-9},
+    {"membot_load_indexes_seconds", "Time to build a matching index of an answer graph", 1e-9},
+    {"membot_match_seconds", "Time to match a message against the keywords of a node", 1e-9},
+    {"membot_match_candidates", "Keywords scored per match", 1.0},
+    {"membot_send_message_seconds", "Time to hand an answer to a front-end", 1e-9},
+};
+
+// every slot starts on a cache line of its own, so threads writing to different slots do not interfere
+struct alignas(64) CounterSlot
+{
+    std::atomic<uint64_t> values[numCounters];
+};
+
+struct alignas(64) HistogramSlot
+{
+    std::atomic<uint64_t> buckets[numHistogramBuckets];
+    std::atomic<uint64_t> sum;
+};
+
+// static storage is zero-initialized, so all metrics start at zero
+static CounterSlot counterSlots[numMetricSlots];
+static HistogramSlot histogramSlots[numMetricSlots][numHistograms];
+static std::atomic<size_t> nextMetricSlot(0);
+
+std::atomic<bool> isMetricsEnabled(false);
+
+static size_t GetMetricSlot()
+{
+    static thread_local const size_t slot = nextMetricSlot.fetch_add(1, std::memory_order_relaxed) % numMetricSlots;
+    return slot;
+}
+
+static size_t GetBucket(uint64_t value)
+{
+    // the bit width of value - 1 is the exponent of the smallest power of two which is not below value
+    size_t bitWidth = 0;
+    for (value = value > 0 ? value - 1 : 0; value != 0; value >>= 1)
+        ++bitWidth;
+    return bitWidth < numHistogramBuckets ? bitWidth : numHistogramBuckets - 1;
+}
+
+void SetMetricsEnabled(bool isEnabled)
+{
+    isMetricsEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+void AddToCounterSlot(MetricCounter counter, uint64_t value)
+{
+    counterSlots[GetMetricSlot()].values[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void RecordInHistogramSlot(MetricHistogram histogram, uint64_t value)
+{
+    HistogramSlot &slot = histogramSlots[GetMetricSlot()][static_cast<size_t>(histogram)];
+    slot.buckets[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    slot.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+// sums of all slots
+struct HistogramSnapshot
+{
+    uint64_t buckets[numHistogramBuckets];
+    uint64_t count;
+    uint64_t sum;
+};
+
+static uint64_t GetCounterValue(size_t counter)
+{
+    uint64_t value = 0;
+    for (const CounterSlot &slot : counterSlots)
+        value += slot.values[counter].load(std::memory_order_relaxed);
+    return value;
+}
+
+static HistogramSnapshot GetHistogramSnapshot(size_t histogram)
+{
+    HistogramSnapshot snapshot{{}, 0, 0};
+    for (size_t s = 0; s < numMetricSlots; ++s)
+    {
+        const HistogramSlot &slot = histogramSlots[s][histogram];
+        for (size_t b = 0; b < numHistogramBuckets; ++b)
+            snapshot.buckets[b] += slot.buckets[b].load(std::memory_order_relaxed);
+        snapshot.sum += slot.sum.load(std::memory_order_relaxed);
+    }
+    for (uint64_t bucket : snapshot.buckets)
+        snapshot.count += bucket;
+    return snapshot;
+}
+
+// upper bound of a bucket in the exported unit, inclusive like the bounds of Prometheus
+static double GetBucketBound(size_t bucket, double scale)
+{
+    return std::ldexp(1.0, static_cast<int>(bucket)) * scale;
+}
+
+void WriteMetricsPrometheus(std::ostream &output)
+{
+    for (size_t c = 0; c < numCounters; ++c)
+    {
+        const MetricInfo &info = counterInfos[c];
+        output << "# HELP " << info.name << " " << info.help << "\n# TYPE " << info.name << " counter\n";
+        output << info.name << " " << GetCounterValue(c) << "\n";
+    }
+
+    for (size_t h = 0; h < numHistograms; ++h)
+    {
+        const MetricInfo &info = histogramInfos[h];
+        HistogramSnapshot snapshot = GetHistogramSnapshot(h);
+        output << "# HELP " << info.name << " " << info.help << "\n# TYPE " << info.name << " histogram\n";
+
+        // buckets are cumulative, the last bucket only catches outliers and is covered by +Inf
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b + 1 < numHistogramBuckets; ++b)
+        {
+            cumulative += snapshot.buckets[b];
+            output << info.name << "_bucket{le=\"" << GetBucketBound(b, info.scale) << "\"} " << cumulative << "\n";
+        }
+        output << info.name << "_bucket{le=\"+Inf\"} " << snapshot.count << "\n";
+        output << info.name << "_sum " << snapshot.sum * info.scale << "\n";
+        output << info.name << "_count " << snapshot.count << "\n";
+    }
+}
+
+void WriteMetricsJson(std::ostream &output)
+{
+    output << "{\"counters\": {";
+    for (size_t c = 0; c < numCounters; ++c)
+        output << (c == 0 ? "" : ", ") << "\"" << counterInfos[c].name << "\": " << GetCounterValue(c);
+
+    // only the buckets up to the highest non-empty one are written, as cumulative counts like in Prometheus
+    output << "}, \"histograms\": {";
+    for (size_t h = 0; h < numHistograms; ++h)
+    {
+        const MetricInfo &info = histogramInfos[h];
+        HistogramSnapshot snapshot = GetHistogramSnapshot(h);
+        output << (h == 0 ? "" : ", ") << "\"" << info.name << "\": {\"count\": " << snapshot.count << ", \"sum\": " << snapshot.sum * info.scale << ", \"buckets\": [";
+
+        size_t numUsedBuckets = numHistogramBuckets;
+        while (numUsedBuckets > 0 && snapshot.buckets[numUsedBuckets - 1] == 0)
+            --numUsedBuckets;
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < numUsedBuckets; ++b)
+        {
+            cumulative += snapshot.buckets[b];
+            output << (b == 0 ? "" : ", ") << "{\"le\": " << GetBucketBound(b, info.scale) << ", \"count\": " << cumulative << "}";
+        }
+        output << "]}";
+    }
+    output << "}}" << std::endl;
+}
+
+void ResetMetrics()
+{
+    for (CounterSlot &slot : counterSlots)
+    {
+        for (std::atomic<uint64_t> &value : slot.values)
+            value.store(0, std::memory_order_relaxed);
+    }
+    for (auto &slots : histogramSlots)
+    {
+        for (HistogramSlot &slot : slots)
+        {
+            for (std::atomic<uint64_t> &bucket : slot.buckets)
+                bucket.store(0, std::memory_order_relaxed);
+            slot.sum.store(0, std::memory_order_relaxed);
+        }
+    }
+}
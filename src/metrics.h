@@ -0,0 +1,93 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <ostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// low-overhead instrumentation of the hot paths (loading, matching, sending answers)
+// all metrics are process-wide and disabled by default; while disabled, every instrumentation point costs one relaxed
+// load of a flag and a branch, no clock is read and nothing is written
+// each thread counts into a slot of its own (slots are assigned round-robin), so threads do not contend for cache lines;
+// slots are only summed up when a snapshot is exported, which needs no locks either
+
+// monotonic counters
+enum class MetricCounter
+{
+    KeywordsScored,   // distance computations and token hits of all matching strategies
+    MatchCacheHits,   // see MatchCache
+    MatchCacheMisses,
+    MessagesSent,     // answers handed to a front-end
+    NumCounters
+};
+
+// distributions of durations (in nanoseconds, exported in seconds) or counts, in power-of-two buckets
+enum class MetricHistogram
+{
+    LoadMapFile,     // LoadFromFile: mapping the file
+    LoadTokenize,    // LoadFromFile: parsing the lines into records
+    LoadLink,        // LoadFromFile: resolving node and edge IDs
+    LoadRootDetection,
+    LoadLayout,      // LoadFromFile: building the tables and normalizing keywords
+    LoadIndexes,     // keyword trees and token index, built while loading text files and on first use for images
+    Match,           // AnswerGraph::FindBestMatch including the match cache
+    MatchCandidates, // keywords scored per match (a count, not a duration)
+    SendMessage,     // handing an answer to a front-end callback
+    NumHistograms
+};
+
+// flag checked by every instrumentation point, kept inline so checking it is as cheap as possible
+extern std::atomic<bool> isMetricsEnabled;
+
+inline bool IsMetricsEnabled() { return isMetricsEnabled.load(std::memory_order_relaxed); }
+void SetMetricsEnabled(bool isEnabled);
+
+// recording, only call these if IsMetricsEnabled() returns true (or use the inline wrappers below)
+void AddToCounterSlot(MetricCounter counter, uint64_t value);
+void RecordInHistogramSlot(MetricHistogram histogram, uint64_t value);
+
+inline void AddToCounter(MetricCounter counter, uint64_t value = 1)
+{
+    if (IsMetricsEnabled())
+        AddToCounterSlot(counter, value);
+}
+
+inline void RecordValue(MetricHistogram histogram, uint64_t value)
+{
+    if (IsMetricsEnabled())
+        RecordInHistogramSlot(histogram, value);
+}
+
+// records the time between construction and destruction in a duration histogram
+class ScopedTimer
+{
+private:
+    // proprietary members
+    MetricHistogram _histogram;
+    bool _isActive; // metrics may be enabled while the timer is running, only timers started while enabled record
+    std::chrono::steady_clock::time_point _start;
+
+public:
+    // constructor / destructor
+    explicit ScopedTimer(MetricHistogram histogram) : _histogram(histogram), _isActive(IsMetricsEnabled())
+    {
+        if (_isActive)
+            _start = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer()
+    {
+        if (_isActive)
+            RecordInHistogramSlot(_histogram, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count());
+    }
+    ScopedTimer(const ScopedTimer &source) = delete;
+    ScopedTimer &operator=(const ScopedTimer &source) = delete;
+};
+
+// export a snapshot of all metrics, e.g. for the textfile collector of Prometheus or for periodic JSON dumps
+// values written by other threads while the snapshot is taken may or may not be included
+void WriteMetricsPrometheus(std::ostream &output);
+void WriteMetricsJson(std::ostream &output);
+void ResetMetrics();
+
+#endif /* METRICS_H_ */
@@ -0,0 +1,26 @@
+#include "pcg32.h"
+
+// SplitMix64 step, spreads the bits of a simple seed over the whole state
+static uint64_t MixSeed(uint64_t &seed)
+{
+    uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+Pcg32::Pcg32(uint64_t seed)
+{
+    _state = MixSeed(seed);
+    _increment = MixSeed(seed) | 1;
+}
+
+Pcg32::result_type Pcg32::operator()()
+{
+    // advance the linear congruential state, the output is a permutation of the previous state
+    uint64_t state = _state;
+    _state = state * 6364136223846793005ull + _increment;
+    uint32_t xorShifted = static_cast<uint32_t>(((state >> 18) ^ state) >> 27);
+    uint32_t rotation = static_cast<uint32_t>(state >> 59);
+    return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
@@ -0,0 +1,28 @@
+#ifndef PCG32_H_
+#define PCG32_H_
+
+#include <cstdint>
+
+// small and fast random generator (PCG-XSH-RR by M. O'Neill) with 16 bytes of state, instead of the 5 KB of std::mt19937
+// it satisfies the requirements of a uniform random bit generator, so it can be used with the std distributions
+// seeds are scrambled, so consecutive seeds (e.g. one per session) still give unrelated sequences
+class Pcg32
+{
+private:
+    // proprietary members
+    uint64_t _state;
+    uint64_t _increment; // selects one of 2^63 sequences, always odd
+
+public:
+    typedef uint32_t result_type;
+
+    // constructor / destructor
+    explicit Pcg32(uint64_t seed = 0);
+
+    // proprietary functions
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+    result_type operator()();
+};
+
+#endif /* PCG32_H_ */
@@ -0,0 +1,325 @@
+#include <algorithm>
+#include <random>
+#include "answergraph.h"
+#include "metrics.h"
+#include "sessionscheduler.h"
+
+// number of messages a worker answers for a session before it lets other sessions have their turn
+const size_t sessionQuantum = 16;
+
+// worker index of the calling thread, so sessions posted from a worker stay in that worker's queue
+static thread_local const void *currentScheduler = nullptr;
+static thread_local size_t currentWorker = 0;
+
+SessionScheduler::SessionScheduler(std::shared_ptr<const GraphPublisher> publisher, unsigned int numThreads, SessionResponseCallback callback)
+    : _publisher(std::move(publisher)), _callback(std::move(callback)), _nextWorker(0), _nextSeed(std::random_device{}()), _movedGraphVersion(_publisher->GetVersion()), _numQueuedSessions(0), _numPendingMessages(0)
+{
+    _isStopping = false;
+
+    numThreads = std::max(1u, numThreads);
+    for (unsigned int i = 0; i < numThreads; ++i)
+        _workers.emplace_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < _workers.size(); ++i)
+        _workers[i]->thread = std::thread(&SessionScheduler::RunWorker, this, i);
+}
+
+SessionScheduler::~SessionScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+        _isStopping = true;
+    }
+
+    // empty all mailboxes, so the workers only finish the messages they are answering and skip the queued sessions
+    size_t numDiscarded = 0;
+    for (SessionTable &table : _sessionTables)
+    {
+        std::lock_guard<std::mutex> tableLock(table.mutex);
+        for (auto &entry : table.sessions)
+        {
+            std::lock_guard<std::mutex> lock(entry.second->mutex);
+            numDiscarded += entry.second->messages.size();
+            entry.second->messages.clear();
+        }
+    }
+    FinishMessages(numDiscarded);
+
+    _workCondition.notify_all();
+    for (std::unique_ptr<Worker> &worker : _workers)
+        worker->thread.join();
+}
+
+SessionScheduler::SessionTable &SessionScheduler::GetSessionTable(const std::string &sessionId)
+{
+    return _sessionTables[std::hash<std::string>()(sessionId) % numSessionTables];
+}
+
+SessionScheduler::Session &SessionScheduler::GetSession(SessionTable &table, const std::string &sessionId)
+{
+    std::unique_ptr<Session> &session = table.sessions[sessionId];
+    if (session == nullptr)
+    {
+        // new sessions are positioned at the root node, so their first message is matched against its edges
+        session = std::make_unique<Session>();
+        session->id = sessionId;
+        session->session = ChatSession(_publisher, _nextSeed++);
+        session->session.Start();
+        session->isQueued = false;
+        session->isClosed = false;
+    }
+
+    return *session;
+}
+
+void SessionScheduler::PostMessage(const std::string &sessionId, std::string message)
+{
+    _numPendingMessages++;
+
+    // the table stays locked until the message is in the mailbox, so the session cannot be closed in between
+    SessionTable &table = GetSessionTable(sessionId);
+    Session *session;
+    bool isNewlyQueued = false;
+    {
+        std::lock_guard<std::mutex> tableLock(table.mutex);
+        session = &GetSession(table, sessionId);
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->messages.push_back(std::move(message));
+        session->lastPostTime = std::chrono::steady_clock::now();
+        isNewlyQueued = !session->isQueued;
+        session->isQueued = true;
+    }
+
+    // a session which is already queued (or being processed) takes the message along, which keeps the order
+    if (isNewlyQueued)
+        QueueSession(session, currentScheduler == this ? currentWorker : _nextWorker++ % _workers.size());
+}
+
+void SessionScheduler::CloseSession(const std::string &sessionId)
+{
+    SessionTable &table = GetSessionTable(sessionId);
+    size_t numDiscarded = 0;
+    {
+        std::lock_guard<std::mutex> tableLock(table.mutex);
+        auto entry = table.sessions.find(sessionId);
+        if (entry == table.sessions.end())
+            return;
+
+        std::unique_ptr<Session> session = std::move(entry->second);
+        table.sessions.erase(entry);
+
+        // the lock is released before the session is deleted
+        std::lock_guard<std::mutex> lock(session->mutex);
+        numDiscarded = session->messages.size();
+        session->messages.clear();
+        if (session->isQueued)
+        {
+            // a worker still refers to the session, it takes over the ownership
+            session->isClosed = true;
+            session.release();
+        }
+    }
+    FinishMessages(numDiscarded);
+}
+
+size_t SessionScheduler::CloseIdleSessions(std::chrono::steady_clock::duration maxIdleTime)
+{
+    // queued sessions are never idle, so no worker refers to the sessions deleted here
+    std::chrono::steady_clock::time_point minPostTime = std::chrono::steady_clock::now() - maxIdleTime;
+    size_t numClosed = 0;
+    for (SessionTable &table : _sessionTables)
+    {
+        std::lock_guard<std::mutex> tableLock(table.mutex);
+        for (auto entry = table.sessions.begin(); entry != table.sessions.end();)
+        {
+            bool isIdle;
+            {
+                std::lock_guard<std::mutex> lock(entry->second->mutex);
+                isIdle = !entry->second->isQueued && entry->second->lastPostTime <= minPostTime;
+            }
+            if (isIdle)
+            {
+                entry = table.sessions.erase(entry);
+                ++numClosed;
+            }
+            else
+            {
+                ++entry;
+            }
+        }
+    }
+    return numClosed;
+}
+
+size_t SessionScheduler::MoveIdleSessionsToPublishedGraph()
+{
+    uint64_t version = _publisher->GetVersion();
+    if (_movedGraphVersion.load() == version)
+        return 0;
+
+    // a session which is not queued is not held by any worker, and it cannot be queued while its lock is held
+    // queued sessions need not be moved: they switch over as soon as one of their messages leads them to the root node
+    size_t numMoved = 0;
+    for (SessionTable &table : _sessionTables)
+    {
+        std::lock_guard<std::mutex> tableLock(table.mutex);
+        for (auto &entry : table.sessions)
+        {
+            std::lock_guard<std::mutex> lock(entry.second->mutex);
+            if (!entry.second->isQueued && entry.second->session.MoveToPublishedGraph())
+                ++numMoved;
+        }
+    }
+
+    // the version is only recorded once all sessions have been visited, so a concurrent call does not skip the sweep
+    _movedGraphVersion.store(version);
+    return numMoved;
+}
+
+size_t SessionScheduler::GetNumberOfSessions()
+{
+    size_t numSessions = 0;
+    for (SessionTable &table : _sessionTables)
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        numSessions += table.sessions.size();
+    }
+    return numSessions;
+}
+
+void SessionScheduler::FinishMessages(size_t numMessages)
+{
+    if (numMessages > 0 && (_numPendingMessages -= numMessages) == 0)
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+        _doneCondition.notify_all();
+    }
+}
+
+void SessionScheduler::QueueSession(Session *session, size_t worker)
+{
+    {
+        std::lock_guard<std::mutex> lock(_workers[worker]->mutex);
+        _workers[worker]->sessions.push_back(session);
+    }
+    _numQueuedSessions++;
+
+    // take the lock so a worker which is about to wait cannot miss the notification
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+    }
+    _workCondition.notify_one();
+}
+
+SessionScheduler::Session *SessionScheduler::TakeSession(size_t worker)
+{
+    // own queue first (most recently queued session, its data is most likely still in the cache)
+    {
+        Worker &own = *_workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.sessions.empty())
+        {
+            Session *session = own.sessions.back();
+            own.sessions.pop_back();
+            return session;
+        }
+    }
+
+    // steal the oldest session of another worker
+    for (size_t i = 1; i < _workers.size(); ++i)
+    {
+        Worker &victim = *_workers[(worker + i) % _workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.sessions.empty())
+        {
+            Session *session = victim.sessions.front();
+            victim.sessions.pop_front();
+            return session;
+        }
+    }
+
+    return nullptr;
+}
+
+void SessionScheduler::ProcessSession(Session &session, size_t worker)
+{
+    std::string message;
+    size_t numAnswered = 0;
+    while (true)
+    {
+        bool isReleased = false;
+        bool isClosed = false;
+        {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            if (session.messages.empty())
+            {
+                // the session is released before its last answer is counted, so once WaitUntilIdle has returned,
+                // idle sessions are no longer marked as queued (and can be moved or closed as idle)
+                session.isQueued = false;
+                isReleased = true;
+                isClosed = session.isClosed; // closed sessions have no messages and do not receive any
+            }
+            else if (numAnswered < sessionQuantum)
+            {
+                message = std::move(session.messages.front());
+                session.messages.pop_front();
+            }
+        }
+        if (numAnswered > 0)
+            FinishMessages(1);
+
+        if (isReleased)
+        {
+            if (isClosed)
+                delete &session;
+            return;
+        }
+
+        // quantum used up: queue the session again behind the others of this worker
+        if (numAnswered == sessionQuantum)
+        {
+            std::lock_guard<std::mutex> lock(_workers[worker]->mutex);
+            _workers[worker]->sessions.push_front(&session);
+            _numQueuedSessions++;
+            return;
+        }
+
+        std::string_view answer = message.empty() ? session.session.Start() : session.session.ReceiveMessage(message);
+        if (_callback)
+        {
+            ScopedTimer timer(MetricHistogram::SendMessage);
+            AddToCounter(MetricCounter::MessagesSent);
+            _callback(session.id, answer);
+        }
+        ++numAnswered;
+    }
+}
+
+void SessionScheduler::RunWorker(size_t worker)
+{
+    currentScheduler = this;
+    currentWorker = worker;
+
+    while (true)
+    {
+        Session *session = TakeSession(worker);
+        if (session != nullptr)
+        {
+            _numQueuedSessions--;
+            ProcessSession(*session, worker);
+            continue;
+        }
+
+        // nothing to do anywhere: sleep until a session is queued
+        // on shutdown the queues are emptied first, so sessions closed while queued are deleted
+        std::unique_lock<std::mutex> lock(_idleMutex);
+        _workCondition.wait(lock, [this]() { return _isStopping || _numQueuedSessions > 0; });
+        if (_isStopping && _numQueuedSessions == 0)
+            return;
+    }
+}
+
+void SessionScheduler::WaitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(_idleMutex);
+    _doneCondition.wait(lock, [this]() { return _numPendingMessages == 0; });
+}
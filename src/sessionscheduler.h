@@ -0,0 +1,114 @@
+#ifndef SESSIONSCHEDULER_H_
+#define SESSIONSCHEDULER_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include "chatsession.h"
+#include "graphpublisher.h"
+
+// called with every answer, on the worker thread which has processed the message
+typedef std::function<void(const std::string &sessionId, std::string_view answer)> SessionResponseCallback;
+
+// executor which answers the messages of many sessions on a pool of worker threads
+// - the messages of a session are processed strictly in the order they were posted, as a session is only ever
+//   queued at one worker at a time
+// - different sessions run in parallel, every worker has its own queue of sessions with pending messages
+//   and idle workers steal sessions from the queues of busy workers
+// - the answer graph is immutable, so workers read it without any locking; sessions follow the graphs published
+//   (see GraphPublisher), so a graph can be replaced while the scheduler is running
+class SessionScheduler
+{
+private:
+    // proprietary type definitions
+    struct Session
+    {
+        std::string id;
+        ChatSession session; // only touched by the worker which currently holds the session
+        std::mutex mutex;    // protects messages, isQueued and lastPostTime
+        std::deque<std::string> messages;
+        std::chrono::steady_clock::time_point lastPostTime;
+        bool isQueued; // true while the session is in a worker queue or being processed
+        bool isClosed; // closed while queued, the worker which holds the session deletes it
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Session *> sessions; // the owner takes from the back, thieves from the front
+        std::thread thread;
+    };
+
+    // sessions are looked up in one of several independently locked tables, so posting scales with threads
+    struct SessionTable
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::unique_ptr<Session>> sessions;
+    };
+    static const size_t numSessionTables = 64;
+
+    // data handles (shared)
+    std::shared_ptr<const GraphPublisher> _publisher;
+
+    // proprietary members
+    SessionResponseCallback _callback;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    SessionTable _sessionTables[numSessionTables];
+    std::atomic<uint32_t> _nextWorker;
+    std::atomic<uint32_t> _nextSeed;
+    std::atomic<uint64_t> _movedGraphVersion; // publisher version the idle sessions have last been moved to
+
+    // idle handling
+    std::mutex _idleMutex;
+    std::condition_variable _workCondition; // signalled when a session has been queued or on shutdown
+    std::condition_variable _doneCondition; // signalled when the last pending message has been answered
+    std::atomic<size_t> _numQueuedSessions;
+    std::atomic<size_t> _numPendingMessages;
+    bool _isStopping;
+
+    // proprietary functions
+    SessionTable &GetSessionTable(const std::string &sessionId);
+    Session &GetSession(SessionTable &table, const std::string &sessionId); // table has to be locked
+    void FinishMessages(size_t numMessages); // answered or discarded, wakes up WaitUntilIdle after the last one
+    void QueueSession(Session *session, size_t worker);
+    Session *TakeSession(size_t worker);
+    void ProcessSession(Session &session, size_t worker);
+    void RunWorker(size_t worker);
+
+public:
+    // constructor / destructor
+    SessionScheduler(std::shared_ptr<const GraphPublisher> publisher, unsigned int numThreads, SessionResponseCallback callback);
+    ~SessionScheduler(); // pending messages are discarded, only the messages being answered are finished
+    SessionScheduler(const SessionScheduler &source) = delete;
+    SessionScheduler &operator=(const SessionScheduler &source) = delete;
+
+    // getter / setter
+    size_t GetNumberOfThreads() const { return _workers.size(); }
+    size_t GetNumberOfSessions();
+
+    // proprietary functions
+    // may be called from any thread, unknown sessions are created and positioned at the root node
+    // an empty message (re)starts a session and is answered with the welcome answer
+    void PostMessage(const std::string &sessionId, std::string message);
+    // forgets a session and discards its pending messages, a message which is being answered is still delivered
+    // posting to the same ID afterwards starts a new session
+    void CloseSession(const std::string &sessionId);
+    // closes all sessions without pending messages which have not received a message for at least maxIdleTime,
+    // returns the number of sessions closed
+    size_t CloseIdleSessions(std::chrono::steady_clock::duration maxIdleTime);
+    // moves all sessions which wait at the root node without pending messages to the published graph (see
+    // ChatSession::MoveToPublishedGraph), returns the number of sessions moved; cheap unless a new graph has been published
+    size_t MoveIdleSessionsToPublishedGraph();
+    void WaitUntilIdle(); // blocks until all messages posted so far have been answered
+};
+
+#endif /* SESSIONSCHEDULER_H_ */
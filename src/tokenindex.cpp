@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cctype>
+#include "levenshtein.h"
+#include "metrics.h"
+#include "memoryusage.h"
+#include "tokenindex.h"
+
+static bool IsTokenDelimiter(char c)
+{
+    return std::isspace(static_cast<unsigned char>(c)) || std::ispunct(static_cast<unsigned char>(c));
+}
+
+void SplitIntoTokens(std::string_view text, std::vector<std::string_view> &tokens)
+{
+    tokens.clear();
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        while (pos < text.size() && IsTokenDelimiter(text[pos]))
+            ++pos;
+        size_t posTokenEnd = pos;
+        while (posTokenEnd < text.size() && !IsTokenDelimiter(text[posTokenEnd]))
+            ++posTokenEnd;
+        if (posTokenEnd > pos)
+            tokens.push_back(text.substr(pos, posTokenEnd - pos));
+        pos = posTokenEnd;
+    }
+}
+
+void TokenIndex::Build(const KeywordIndex &keywords)
+{
+    _tokens.clear();
+    _firstPostings.clear();
+    _postings.clear();
+    _numKeywordTokens.assign(keywords.GetNumberOfKeywords(), 0);
+
+    // collect the distinct words of every keyword as (token, keyword) pairs
+    std::vector<std::pair<uint32_t, uint32_t>> occurrences;
+    std::vector<std::string_view> words;
+    std::vector<uint32_t> keywordTokens;
+    for (uint32_t keyword = 0; keyword < keywords.GetNumberOfKeywords(); ++keyword)
+    {
+        SplitIntoTokens(keywords.GetKeywordAtIndex(keyword), words);
+        keywordTokens.clear();
+        for (std::string_view word : words)
+            keywordTokens.push_back(_tokens.emplace(word, static_cast<uint32_t>(_tokens.size())).first->second);
+
+        std::sort(keywordTokens.begin(), keywordTokens.end());
+        keywordTokens.erase(std::unique(keywordTokens.begin(), keywordTokens.end()), keywordTokens.end());
+        _numKeywordTokens[keyword] = keywordTokens.size();
+        for (uint32_t token : keywordTokens)
+            occurrences.emplace_back(token, keyword);
+    }
+
+    // group the pairs by token, keywords are visited in ascending order, so every posting list is sorted
+    _firstPostings.assign(_tokens.size() + 1, 0);
+    for (const auto &occurrence : occurrences)
+        _firstPostings[occurrence.first + 1]++;
+    for (size_t i = 1; i < _firstPostings.size(); ++i)
+        _firstPostings[i] += _firstPostings[i - 1];
+
+    std::vector<uint32_t> numPostings(_tokens.size(), 0);
+    _postings.resize(occurrences.size());
+    for (const auto &occurrence : occurrences)
+        _postings[_firstPostings[occurrence.first] + numPostings[occurrence.first]++] = occurrence.second;
+}
+
+size_t TokenIndex::GetMemoryUsage() const
+{
+    return GetHeapMemoryUsage(_tokens) + GetHeapMemoryUsage(_firstPostings) + GetHeapMemoryUsage(_postings) + GetHeapMemoryUsage(_numKeywordTokens);
+}
+
+KeywordMatch TokenIndex::FindBestMatch(const KeywordIndex &keywords, uint32_t firstKeyword, uint32_t numKeywords, std::string_view query) const
+{
+    // the scratch buffers are reused between messages to avoid heap allocations
+    thread_local std::vector<std::string_view> words;
+    thread_local std::vector<uint32_t> hits;
+    SplitIntoTokens(query, words);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    // collect the keywords of the node for every word of the query, a keyword appears once per shared word
+    hits.clear();
+    for (std::string_view word : words)
+    {
+        auto token = _tokens.find(word);
+        if (token == _tokens.end())
+            continue;
+
+        auto postingsEnd = _postings.begin() + _firstPostings[token->second + 1];
+        auto posting = std::lower_bound(_postings.begin() + _firstPostings[token->second], postingsEnd, firstKeyword);
+        for (; posting != postingsEnd && *posting < firstKeyword + numKeywords; ++posting)
+            hits.push_back(*posting);
+    }
+    std::sort(hits.begin(), hits.end());
+
+    // score every keyword which has been hit by the number of its words missing in the query
+    KeywordMatch best{nullptr, unboundedDistance};
+    uint32_t bestHits = 0;
+    for (size_t i = 0; i < hits.size();)
+    {
+        uint32_t keyword = hits[i];
+        uint32_t numHits = 0;
+        for (; i < hits.size() && hits[i] == keyword; ++i)
+            ++numHits;
+
+        int distance = _numKeywordTokens[keyword] - numHits;
+        if (distance < best.distance || (distance == best.distance && numHits > bestHits))
+        {
+            best.edge = keywords.GetEdgeAtIndex(keyword);
+            best.distance = distance;
+            bestHits = numHits;
+        }
+    }
+
+    // every hit counts as a scored candidate, even if several hits belong to the same keyword
+    if (IsMetricsEnabled())
+    {
+        RecordInHistogramSlot(MetricHistogram::MatchCandidates, hits.size());
+        AddToCounterSlot(MetricCounter::KeywordsScored, hits.size());
+    }
+    return best;
+}
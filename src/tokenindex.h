@@ -0,0 +1,42 @@
+#ifndef TOKENINDEX_H_
+#define TOKENINDEX_H_
+
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+#include "keywordindex.h"
+
+// split text into words, i.e. runs of characters which are neither white space nor punctuation
+// tokens is overwritten but keeps its capacity, the tokens are views into text
+void SplitIntoTokens(std::string_view text, std::vector<std::string_view> &tokens);
+
+// inverted index from the words of all keywords of a graph to the keywords containing them
+// a message is matched by looking up each of its words, so only keywords sharing a word with the message are scored
+// and the cost of a message depends on its length and the number of hits instead of the number of keywords
+// keywords are referred to by their position in the keyword table of the graph, so the keywords of a node form a range
+class TokenIndex
+{
+private:
+    // proprietary members
+    std::unordered_map<std::string_view, uint32_t> _tokens; // word -> index into _firstPostings, views into the string pool
+    std::vector<uint32_t> _firstPostings;                   // CSR layout, postings of token i lie in [_firstPostings[i], _firstPostings[i + 1])
+    std::vector<uint32_t> _postings;                        // keywords containing a token, in ascending order
+    std::vector<uint32_t> _numKeywordTokens;               // number of distinct words per keyword
+
+public:
+    // getter / setter
+    size_t GetNumberOfTokens() const { return _tokens.size(); }
+    size_t GetMemoryUsage() const; // heap bytes
+
+    // proprietary functions
+    void Build(const KeywordIndex &keywords); // keywords has to cover the complete keyword table
+
+    // closest edge among the keywords [firstKeyword, firstKeyword + numKeywords) for a normalized query
+    // a keyword is closer the fewer of its words are missing in the query, then the more of its words are found in the query
+    // (the first keyword wins among equally close ones), distance is the number of missing words
+    // edge is nullptr if no keyword shares a word with the query
+    KeywordMatch FindBestMatch(const KeywordIndex &keywords, uint32_t firstKeyword, uint32_t numKeywords, std::string_view query) const;
+};
+
+#endif /* TOKENINDEX_H_ */
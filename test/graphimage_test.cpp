@@ -0,0 +1,135 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cstring>
+#include "answergraph.h"
+#include "graphimage.h"
+#include "graphparser.h"
+#include "graphgenerator.h"
+#include "testing.h"
+
+// text -> image -> text round trip, and rejection of corrupt images
+
+// write a loaded graph back in the answer graph file format, nodes and edges in table order
+static std::string WriteGraphText(const AnswerGraph &graph)
+{
+    std::ostringstream output;
+    for (size_t i = 0; i < graph.GetNumberOfNodes(); ++i)
+    {
+        const GraphNode &node = *graph.GetNodeAtIndex(i);
+        output << "<TYPE:NODE><ID:" << node.GetID() << ">";
+        for (size_t a = 0; a < node.GetNumberOfAnswers(); ++a)
+            output << "<ANSWER:" << graph.GetAnswer(node, a) << ">";
+        output << "\n";
+    }
+    for (size_t i = 0; i < graph.GetNumberOfNodes(); ++i)
+    {
+        const GraphNode &node = *graph.GetNodeAtIndex(i);
+        for (size_t e = 0; e < node.GetNumberOfChildEdges(); ++e)
+        {
+            const GraphEdge &edge = *graph.GetChildEdge(node, e);
+            output << "<TYPE:EDGE><ID:" << edge.GetID() << "><PARENT:" << graph.GetParentNode(edge)->GetID() << "><CHILD:" << graph.GetChildNode(edge)->GetID() << ">";
+            for (size_t k = 0; k < edge.GetNumberOfKeywords(); ++k)
+                output << "<KEYWORD:" << graph.GetKeyword(edge, k) << ">";
+            output << "\n";
+        }
+    }
+    return output.str();
+}
+
+static void WriteFile(const std::string &filename, const std::string &content)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+static bool OpenImage(std::vector<char> &content)
+{
+    GraphImage image;
+    return image.Open(std::string_view(content.data(), content.size())) && image.Validate();
+}
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string textFile = (directory / "graphimage_test.txt").string();
+    std::string imageFile = (directory / "graphimage_test.img").string();
+
+    // generated graph with cycles and repeated keywords, plus the graph shipped with the chatbot
+    GraphGeneratorOptions options;
+    options.numNodes = 5000;
+    options.cycleRatio = 0.2;
+    options.vocabularySize = 300;
+    std::ostringstream generated;
+    GenerateGraph(options, generated);
+    std::string shipped;
+    {
+        std::ifstream file(MEMBOT_SOURCE_DIR "/src/answergraph.txt", std::ios::binary);
+        shipped.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    CHECK(!shipped.empty());
+
+    for (const std::string &content : {generated.str(), shipped})
+    {
+        WriteFile(textFile, content);
+        AnswerGraph fromText;
+        CHECK(fromText.LoadFromFile(textFile));
+
+        GraphRecordTable records;
+        ParseGraphRecords(content, 1, records);
+        GraphImageBuilder builder;
+        builder.AddRecords(records);
+        CHECK(builder.Write(imageFile));
+
+        AnswerGraph fromImage;
+        CHECK(fromImage.LoadFromFile(imageFile));
+        std::string text = WriteGraphText(fromImage);
+        CHECK(text == WriteGraphText(fromText));
+
+        // the text written from the image is loaded into the same graph again
+        WriteFile(textFile, text);
+        AnswerGraph fromRoundTrip;
+        CHECK(fromRoundTrip.LoadFromFile(textFile));
+        CHECK(WriteGraphText(fromRoundTrip) == text);
+        CHECK(fromRoundTrip.GetRootNode() != nullptr && fromRoundTrip.GetRootNode()->GetID() == fromImage.GetRootNode()->GetID());
+        for (size_t i = 0; i < fromImage.GetNumberOfNodes(); ++i)
+        {
+            KeywordIndex keywords1 = fromImage.GetKeywordIndex(*fromImage.GetNodeAtIndex(i));
+            KeywordIndex keywords2 = fromRoundTrip.GetKeywordIndex(*fromRoundTrip.GetNodeAtIndex(i));
+            CHECK_EQUAL(keywords1.GetNumberOfKeywords(), keywords2.GetNumberOfKeywords());
+        }
+    }
+
+    // corrupt images are rejected instead of being read out of bounds
+    GraphRecordTable records;
+    ParseGraphRecords(shipped, 1, records);
+    GraphImageBuilder builder;
+    builder.AddRecords(records);
+    std::vector<char> image;
+    CHECK(builder.Build(image));
+    CHECK(OpenImage(image));
+
+    std::vector<char> corrupt = image;
+    GraphImageHeader &header = *reinterpret_cast<GraphImageHeader *>(corrupt.data());
+    header.rootNode = header.numNodes;
+    CHECK(!OpenImage(corrupt));
+
+    corrupt = image;
+    GraphEdge edge(1, 0, header.numNodes + 5);
+    std::memcpy(corrupt.data() + header.edgesOffset, &edge, sizeof(edge));
+    CHECK(!OpenImage(corrupt));
+
+    corrupt = image;
+    ImageString answer{static_cast<uint32_t>(header.stringPoolSize), 10};
+    std::memcpy(corrupt.data() + header.answersOffset, &answer, sizeof(answer));
+    CHECK(!OpenImage(corrupt));
+
+    corrupt.resize(header.stringPoolOffset);
+    CHECK(!OpenImage(corrupt));
+
+    std::filesystem::remove(textFile);
+    std::filesystem::remove(imageFile);
+    return GetTestResult();
+}
@@ -0,0 +1,87 @@
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include "graphparser.h"
+#include "graphgenerator.h"
+#include "testing.h"
+
+// the parallel parser has to produce the same table as the serial one, wherever the chunk boundaries fall
+
+static bool IsEqual(const GraphRecordEntry &entry1, const GraphRecordEntry &entry2)
+{
+    return entry1.id == entry2.id && entry1.parentId == entry2.parentId && entry1.childId == entry2.childId && entry1.hasParent == entry2.hasParent &&
+           entry1.hasChild == entry2.hasChild && entry1.firstString == entry2.firstString && entry1.numStrings == entry2.numStrings;
+}
+
+static void CheckEqualTables(const GraphRecordTable &actual, const GraphRecordTable &expected)
+{
+    CHECK_EQUAL(actual.numMissingIds, expected.numMissingIds);
+    CHECK_EQUAL(actual.nodes.size(), expected.nodes.size());
+    CHECK_EQUAL(actual.edges.size(), expected.edges.size());
+    CHECK_EQUAL(actual.strings.size(), expected.strings.size());
+    if (actual.nodes.size() != expected.nodes.size() || actual.edges.size() != expected.edges.size() || actual.strings.size() != expected.strings.size())
+        return;
+
+    size_t numDifferentNodes = 0, numDifferentEdges = 0, numDifferentStrings = 0;
+    for (size_t i = 0; i < expected.nodes.size(); ++i)
+        numDifferentNodes += !IsEqual(actual.nodes[i], expected.nodes[i]);
+    for (size_t i = 0; i < expected.edges.size(); ++i)
+        numDifferentEdges += !IsEqual(actual.edges[i], expected.edges[i]);
+    for (size_t i = 0; i < expected.strings.size(); ++i)
+        numDifferentStrings += actual.strings[i] != expected.strings[i];
+    CHECK_EQUAL(numDifferentNodes, 0u);
+    CHECK_EQUAL(numDifferentEdges, 0u);
+    CHECK_EQUAL(numDifferentStrings, 0u);
+}
+
+int main()
+{
+    // a generated graph of several MB, so it is split into chunks, with lines the parser has to skip or report
+    GraphGeneratorOptions options;
+    options.numNodes = 40000;
+    options.cycleRatio = 0.1;
+    std::ostringstream output;
+    output << "// comment\n<TYPE:NODE><ANSWER:line without id>\n\n";
+    GenerateGraph(options, output);
+    output << "<TYPE:EDGE><ID:999999><PARENT:0><CHILD:1><KEYWORD:last line without newline>";
+    std::string content = output.str();
+    CHECK(content.size() > (8u << 20));
+
+    GraphRecordTable serial;
+    ParseGraphRecords(content, 1, serial);
+    CHECK_EQUAL(serial.nodes.size(), options.numNodes);
+    CHECK_EQUAL(serial.numMissingIds, 1u);
+    CHECK(!serial.edges.empty() && serial.edges.back().id == 999999);
+
+    for (unsigned int numThreads : {2u, 3u, 4u, 7u, 16u})
+    {
+        GraphRecordTable parallel;
+        ParseGraphRecords(content, numThreads, parallel);
+        CheckEqualTables(parallel, serial);
+    }
+
+    // every prefix cut at a line end parses to the records of its lines, also when the cut lands near a chunk boundary
+    for (size_t cut : {content.size() / 2, content.size() / 3, content.size() / 4 + 1})
+    {
+        std::string_view prefix = std::string_view(content).substr(0, content.find('\n', cut) + 1);
+        GraphRecordTable serialPrefix, parallelPrefix;
+        ParseGraphRecords(prefix, 1, serialPrefix);
+        ParseGraphRecords(prefix, 4, parallelPrefix);
+        CheckEqualTables(parallelPrefix, serialPrefix);
+    }
+
+    // progress is reported while parsing, never decreases and ends with the complete content
+    for (unsigned int numThreads : {1u, 4u})
+    {
+        std::vector<float> shares;
+        GraphRecordTable table;
+        ParseGraphRecords(content, numThreads, table, [&shares](float share) { shares.push_back(share); });
+        CHECK(shares.size() > 4);
+        CHECK(std::is_sorted(shares.begin(), shares.end()));
+        CHECK(!shares.empty() && shares.back() == 1.0f);
+    }
+
+    return GetTestResult();
+}
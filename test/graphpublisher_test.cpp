@@ -0,0 +1,96 @@
+#include <string>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include "answergraph.h"
+#include "graphpublisher.h"
+#include "chatsession.h"
+#include "sessionscheduler.h"
+#include "chatlogic.h"
+#include "testing.h"
+
+// reloads release the previous graph once no session uses it any more, also if sessions are left idle
+
+static std::shared_ptr<const AnswerGraph> LoadGraph()
+{
+    auto graph = std::make_shared<AnswerGraph>();
+    if (!graph->LoadFromFile(MEMBOT_SOURCE_DIR "/src/answergraph.txt"))
+        return nullptr;
+    return graph;
+}
+
+static void TestSchedulerReload()
+{
+    auto publisher = std::make_shared<GraphPublisher>();
+    publisher->Publish(LoadGraph());
+    std::weak_ptr<const AnswerGraph> firstGraph = publisher->GetGraph();
+    CHECK(!firstGraph.expired());
+
+    SessionScheduler scheduler(publisher, 2, nullptr);
+    ChatSession standalone(publisher, 1);
+    standalone.Start();
+
+    // one session waits at the root node, the other one in the middle of a dialog
+    scheduler.PostMessage("root", "");
+    scheduler.PostMessage("dialog", "pointer");
+    scheduler.WaitUntilIdle();
+    CHECK_EQUAL(scheduler.MoveIdleSessionsToPublishedGraph(), 0u);
+
+    publisher->Publish(LoadGraph());
+    CHECK_EQUAL(firstGraph.use_count(), 3);
+
+    // only the sessions at the root node are moved, and only once per published graph
+    CHECK_EQUAL(scheduler.MoveIdleSessionsToPublishedGraph(), 1u);
+    CHECK_EQUAL(scheduler.MoveIdleSessionsToPublishedGraph(), 0u);
+    CHECK(standalone.MoveToPublishedGraph());
+    CHECK(standalone.GetAnswerGraph() == publisher->GetGraph().get());
+    CHECK(standalone.GetCurrentNode() == publisher->GetGraph()->GetRootNode());
+    CHECK(!standalone.MoveToPublishedGraph());
+    CHECK_EQUAL(firstGraph.use_count(), 1);
+
+    // the dialog switches over when it returns to the root node ("nullptr" leads to a leaf, which has no edges)
+    scheduler.PostMessage("dialog", "nullptr");
+    scheduler.PostMessage("dialog", "anything");
+    scheduler.WaitUntilIdle();
+    CHECK_EQUAL(firstGraph.use_count(), 0);
+
+    // a session which is left in the middle of a dialog is released by closing it as idle
+    std::weak_ptr<const AnswerGraph> secondGraph = publisher->GetGraph();
+    scheduler.PostMessage("abandoned", "pointer");
+    scheduler.WaitUntilIdle();
+    publisher->Publish(LoadGraph());
+    scheduler.MoveIdleSessionsToPublishedGraph();
+    standalone.MoveToPublishedGraph();
+    CHECK_EQUAL(secondGraph.use_count(), 1);
+    CHECK_EQUAL(scheduler.CloseIdleSessions(std::chrono::hours(1)), 0u);
+    CHECK_EQUAL(scheduler.CloseIdleSessions(std::chrono::seconds(0)), 3u);
+    CHECK_EQUAL(secondGraph.use_count(), 0);
+    CHECK_EQUAL(scheduler.GetNumberOfSessions(), 0u);
+}
+
+static void TestChatLogicReload()
+{
+    ChatLogic chatLogic;
+    chatLogic.LoadAnswerGraphFromFile(MEMBOT_SOURCE_DIR "/src/answergraph.txt");
+    CHECK(chatLogic.StartSessionScheduler(2, nullptr));
+    chatLogic.SendMessageToSession("root", "");
+    chatLogic.WaitForSessions();
+
+    // the reloader moves the idle session on its own, the publisher and the session no longer hold the graph then
+    std::weak_ptr<const AnswerGraph> loadedGraph = chatLogic.GetAnswerGraph();
+    long numUsers = loadedGraph.use_count();
+    chatLogic.ReloadAnswerGraphFromFileAsync(MEMBOT_SOURCE_DIR "/src/answergraph.txt");
+    for (int i = 0; i < 1000 && loadedGraph.use_count() != numUsers - 2; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK_EQUAL(loadedGraph.use_count(), numUsers - 2);
+    chatLogic.WaitForReload();
+    CHECK(chatLogic.GetAnswerGraph() != loadedGraph.lock());
+    chatLogic.StopSessionScheduler();
+}
+
+int main()
+{
+    TestSchedulerReload();
+    TestChatLogicReload();
+    return GetTestResult();
+}
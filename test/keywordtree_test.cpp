@@ -0,0 +1,180 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include "answergraph.h"
+#include "graphimage.h"
+#include "graphparser.h"
+#include "mappedfile.h"
+#include "levenshtein.h"
+#include "keywordindex.h"
+#include "keywordtree.h"
+#include "testing.h"
+
+// the BK-tree has to find the same edge as the linear scan, including the choice among equally close keywords,
+// and the k best matches have to be the first k edges of a linear scan sorted by distance
+// trees of text files are built while loading, those of compiled images on first use
+
+// keyword table over a string pool, two keywords per edge as in a graph with synonyms
+struct KeywordTable
+{
+    std::string strings;
+    std::vector<ImageKeyword> entries;
+    std::vector<GraphEdge> edges;
+
+    KeywordIndex GetIndex() const { return KeywordIndex(entries.data(), entries.size(), strings.data(), edges.data()); }
+};
+
+static std::string MakeWord(std::mt19937 &generator, size_t maxLength)
+{
+    std::string word(1 + generator() % maxLength, 'A');
+    for (char &c : word)
+        c = 'A' + generator() % 3; // few letters, so many keywords are equally close to a query
+    return word;
+}
+
+static KeywordTable MakeTable(std::mt19937 &generator, size_t numKeywords, size_t maxLength)
+{
+    KeywordTable table;
+    for (size_t i = 0; i < numKeywords; ++i)
+    {
+        std::string word = MakeWord(generator, maxLength);
+        if (i > 0 && generator() % 10 == 0)
+        {
+            // some keywords are duplicates of earlier ones
+            const ImageString &earlier = table.entries[generator() % i].keyword;
+            word = table.strings.substr(earlier.offset, earlier.length);
+        }
+        table.entries.push_back(ImageKeyword{ImageString{static_cast<uint32_t>(table.strings.size()), static_cast<uint32_t>(word.size())}, static_cast<uint32_t>(i / 2)});
+        table.strings += word;
+    }
+    for (size_t i = 0; i < (numKeywords + 1) / 2; ++i)
+        table.edges.push_back(GraphEdge(i, 0, i + 1));
+    return table;
+}
+
+// every edge scored by its closest keyword, stably sorted by distance (so equally close edges keep their index order)
+static std::vector<KeywordMatch> ScoreAllEdges(const KeywordIndex &index, std::string_view query)
+{
+    std::vector<KeywordMatch> matches;
+    for (size_t i = 0; i < index.GetNumberOfKeywords(); ++i)
+    {
+        int distance = ComputeLevenshteinDistance(query, index.GetKeywordAtIndex(i));
+        if (!matches.empty() && matches.back().edge == index.GetEdgeAtIndex(i))
+            matches.back().distance = std::min(matches.back().distance, distance);
+        else
+            matches.push_back(KeywordMatch{index.GetEdgeAtIndex(i), distance});
+    }
+    std::stable_sort(matches.begin(), matches.end(), [](const KeywordMatch &a, const KeywordMatch &b) { return a.distance < b.distance; });
+    return matches;
+}
+
+static void CheckBestMatches(const KeywordIndex &index, std::string_view query)
+{
+    std::vector<KeywordMatch> expected = ScoreAllEdges(index, query);
+    std::vector<KeywordMatch> actual;
+    for (size_t k : {0, 1, 3, 10, 1000})
+    {
+        index.FindBestMatches(query, k, actual);
+        CHECK_EQUAL(actual.size(), std::min(k, expected.size()));
+        for (size_t i = 0; i < actual.size() && i < expected.size(); ++i)
+        {
+            CHECK_EQUAL(actual[i].distance, expected[i].distance);
+            CHECK(actual[i].edge == expected[i].edge);
+        }
+    }
+
+    index.FindBestMatches(query, 1, actual);
+    KeywordMatch best = index.FindBestMatch(query);
+    CHECK(actual.empty() ? best.edge == nullptr : actual[0].edge == best.edge);
+}
+
+static void TestLoadedTrees()
+{
+    // a hub node with more keywords than minKeywordTreeSize, and a small node
+    const size_t numChildren = minKeywordTreeSize / 2 + 100;
+    std::ostringstream text;
+    for (size_t i = 0; i <= numChildren; ++i)
+        text << "<TYPE:NODE><ID:" << i << "><ANSWER:answer " << i << ">\n";
+    for (size_t i = 1; i <= numChildren; ++i)
+        text << "<TYPE:EDGE><ID:" << i << "><PARENT:0><CHILD:" << i << "><KEYWORD:keyword " << i << "><KEYWORD:synonym " << i << ">\n";
+    text << "<TYPE:EDGE><ID:0><PARENT:1><CHILD:2><KEYWORD:small>\n";
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string textFile = (directory / "keywordtree_test.txt").string();
+    std::string imageFile = (directory / "keywordtree_test.img").string();
+    {
+        std::ofstream file(textFile, std::ios::binary | std::ios::trunc);
+        file << text.str();
+    }
+
+    AnswerGraph fromText;
+    CHECK(fromText.LoadFromFile(textFile));
+    CHECK_EQUAL(fromText.GetNumberOfKeywordTrees(), 1u);
+
+    {
+        MappedFile file;
+        CHECK(file.Open(textFile));
+        GraphRecordTable records;
+        ParseGraphRecords(file.GetContent(), 1, records);
+        GraphImageBuilder builder;
+        builder.AddRecords(records);
+        CHECK(builder.Write(imageFile));
+    }
+    AnswerGraph fromImage;
+    CHECK(fromImage.LoadFromFile(imageFile));
+    CHECK_EQUAL(fromImage.GetNumberOfKeywordTrees(), 0u);
+    for (const AnswerGraph *graph : {&fromText, &fromImage})
+    {
+        KeywordMatch match = graph->FindBestMatch(*graph->GetRootNode(), "SYNONYM 77");
+        CHECK_EQUAL(match.distance, 0);
+        CHECK(match.edge != nullptr && match.edge->GetID() == 77);
+    }
+    CHECK_EQUAL(fromImage.GetNumberOfKeywordTrees(), 1u);
+
+    std::filesystem::remove(textFile);
+    std::filesystem::remove(imageFile);
+}
+
+int main()
+{
+    std::mt19937 generator(21);
+    for (size_t numKeywords : {1, 2, 10, 100, 1000, 3000})
+    {
+        for (size_t maxLength : {3, 8, 70})
+        {
+            KeywordTable table = MakeTable(generator, numKeywords, maxLength);
+            KeywordIndex index = table.GetIndex();
+            KeywordTree tree;
+            tree.Build(index);
+            CHECK_EQUAL(tree.GetNumberOfNodes(), numKeywords);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                std::string query = MakeWord(generator, maxLength + 2);
+                KeywordMatch expected = index.FindBestMatch(query);
+                LevenshteinPattern pattern(query);
+                KeywordMatch actual = tree.FindBestMatch(index, pattern);
+                CHECK_EQUAL(actual.distance, expected.distance);
+                CHECK(actual.edge == expected.edge);
+                if (numKeywords <= 1000 && i % 10 == 0)
+                    CheckBestMatches(index, query);
+            }
+        }
+    }
+
+    // an empty tree finds nothing
+    KeywordTable empty;
+    KeywordTree tree;
+    tree.Build(empty.GetIndex());
+    LevenshteinPattern pattern("HELLO");
+    CHECK(tree.FindBestMatch(empty.GetIndex(), pattern).edge == nullptr);
+    CheckBestMatches(empty.GetIndex(), "HELLO");
+
+    TestLoadedTrees();
+
+    return GetTestResult();
+}
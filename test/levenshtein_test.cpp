@@ -0,0 +1,125 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "levenshtein.h"
+#include "testing.h"
+
+// distance kernels (bit-parallel, banded and SIMD batches) against the textbook dynamic programming
+
+static int ComputeReferenceDistance(const std::string &s1, const std::string &s2)
+{
+    std::vector<int> row(s2.size() + 1);
+    for (size_t j = 0; j <= s2.size(); ++j)
+        row[j] = j;
+    for (size_t i = 1; i <= s1.size(); ++i)
+    {
+        int diagonal = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= s2.size(); ++j)
+        {
+            int above = row[j];
+            row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (s1[i - 1] == s2[j - 1] ? 0 : 1)});
+            diagonal = above;
+        }
+    }
+    return row[s2.size()];
+}
+
+// result of a bounded computation: exact up to the bound, bound + 1 beyond it
+static int ApplyBound(int distance, int maxDistance)
+{
+    return distance <= maxDistance ? distance : maxDistance + 1;
+}
+
+// small alphabet, so the strings share many characters and distances vary
+static std::string MakeString(std::mt19937 &generator, size_t length)
+{
+    std::string str(length, 'A');
+    for (char &c : str)
+        c = 'A' + generator() % 4;
+    return str;
+}
+
+// similar string with a few edits, so small bounds are hit as well as missed
+static std::string MakeVariant(std::mt19937 &generator, const std::string &source)
+{
+    std::string variant = source;
+    size_t numEdits = generator() % 4;
+    for (size_t i = 0; i < numEdits; ++i)
+    {
+        size_t pos = variant.empty() ? 0 : generator() % variant.size();
+        switch (generator() % 3)
+        {
+        case 0:
+            if (!variant.empty())
+                variant[pos] = 'A' + generator() % 4;
+            break;
+        case 1:
+            variant.insert(variant.begin() + pos, 'A' + generator() % 4);
+            break;
+        default:
+            if (!variant.empty())
+                variant.erase(pos, 1);
+        }
+    }
+    return variant;
+}
+
+int main()
+{
+    std::mt19937 generator(7);
+    const size_t lengths[] = {0, 1, 2, 7, 31, 32, 33, 63, 64, 65, 100, 200};
+    const int bounds[] = {0, 1, 2, 5, 40, unboundedDistance};
+
+    for (size_t length1 : lengths)
+    {
+        for (size_t length2 : lengths)
+        {
+            for (int round = 0; round < 4; ++round)
+            {
+                std::string s1 = MakeString(generator, length1);
+                std::string s2 = length1 == length2 ? MakeVariant(generator, s1) : MakeString(generator, length2);
+                int expected = ComputeReferenceDistance(s1, s2);
+
+                CHECK_EQUAL(ComputeLevenshteinDistance(s1, s2), expected);
+                CHECK_EQUAL(ComputeLevenshteinDistance(s2, s1), expected);
+                LevenshteinPattern pattern(s1);
+                CHECK_EQUAL(pattern.ComputeDistance(s2), expected);
+                for (int bound : bounds)
+                {
+                    CHECK_EQUAL(ComputeLevenshteinDistance(s1, s2, bound), ApplyBound(expected, bound));
+                    CHECK_EQUAL(pattern.ComputeDistance(s2, bound), ApplyBound(expected, bound));
+                }
+            }
+        }
+    }
+
+    // batches of up to 8 texts with mixed lengths, as scored by KeywordIndex
+    for (size_t length : lengths)
+    {
+        for (size_t count = 1; count <= 8; ++count)
+        {
+            std::string query = MakeString(generator, length);
+            std::vector<std::string> texts;
+            for (size_t i = 0; i < count; ++i)
+                texts.push_back(i % 2 == 0 ? MakeVariant(generator, query) : MakeString(generator, lengths[generator() % 12]));
+            std::vector<std::string_view> views(texts.begin(), texts.end());
+
+            LevenshteinPattern pattern(query);
+            for (int bound : bounds)
+            {
+                int distances[8];
+                pattern.ComputeDistances(views.data(), count, distances, bound);
+                for (size_t i = 0; i < count; ++i)
+                    CHECK_EQUAL(distances[i], ApplyBound(ComputeReferenceDistance(query, texts[i]), bound));
+            }
+        }
+    }
+
+    std::string upper;
+    ToUpperCase("Smart Pointers 11", upper);
+    CHECK_EQUAL(upper, std::string("SMART POINTERS 11"));
+
+    return GetTestResult();
+}
@@ -0,0 +1,144 @@
+#include <string>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include "matchcache.h"
+#include "testing.h"
+
+// hit and miss counting, LRU eviction within a shard, per-shard capacity and inserting without allocations
+
+// counts all allocations of the test, so the steady state of a full cache can be checked
+static size_t numAllocations = 0;
+
+void *operator new(size_t size)
+{
+    ++numAllocations;
+    void *memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+static const KeywordMatch someMatch{nullptr, 3};
+
+static bool IsCached(MatchCache &cache, uint32_t node, const std::string &message)
+{
+    KeywordMatch match;
+    return cache.Find(node, message, match);
+}
+
+// messages which land in the same shard as the first one, found by letting them evict each other in a cache
+// which holds a single entry per shard
+static std::vector<std::string> FindMessagesOfOneShard(size_t count)
+{
+    MatchCache probe(1);
+    std::vector<std::string> messages{"MESSAGE 0"};
+    for (size_t i = 1; messages.size() < count; ++i)
+    {
+        std::string message = "MESSAGE " + std::to_string(i);
+        probe.Clear();
+        probe.Insert(0, messages[0], someMatch);
+        probe.Insert(0, message, someMatch);
+        if (!IsCached(probe, 0, messages[0]))
+            messages.push_back(message);
+    }
+    return messages;
+}
+
+static void TestHitsAndMisses()
+{
+    MatchCache cache;
+    KeywordMatch match{nullptr, 0};
+    CHECK(!cache.Find(7, "HELLO", match));
+    cache.Insert(7, "HELLO", someMatch);
+    CHECK(cache.Find(7, "HELLO", match));
+    CHECK_EQUAL(match.distance, someMatch.distance);
+    CHECK(!cache.Find(8, "HELLO", match)); // the node is part of the key
+    CHECK(!cache.Find(7, "HELLO WORLD", match));
+    CHECK_EQUAL(cache.GetNumberOfHits(), 1u);
+    CHECK_EQUAL(cache.GetNumberOfMisses(), 3u);
+    CHECK(cache.GetMemoryUsage() > 0);
+
+    // long messages are not cached at all
+    std::string longMessage(maxCachedMessageLength + 1, 'X');
+    cache.Insert(7, longMessage, someMatch);
+    CHECK(!cache.Find(7, longMessage, match));
+
+    cache.Clear();
+    CHECK_EQUAL(cache.GetNumberOfHits(), 0u);
+    CHECK_EQUAL(cache.GetNumberOfMisses(), 0u);
+    CHECK(!IsCached(cache, 7, "HELLO"));
+
+    // a capacity of 0 disables the cache
+    cache.SetCapacity(0);
+    cache.Insert(7, "HELLO", someMatch);
+    CHECK(!IsCached(cache, 7, "HELLO"));
+}
+
+static void TestEviction()
+{
+    // the capacity is divided among the shards and rounded up to a multiple of their number
+    MatchCache cache(17);
+    size_t shardCapacity = cache.GetCapacity() / 16;
+    CHECK_EQUAL(shardCapacity, 2u);
+    CHECK_EQUAL(cache.GetCapacity(), 32u);
+
+    // the least recently used entry of a shard is evicted, a hit counts as a use
+    std::vector<std::string> messages = FindMessagesOfOneShard(4);
+    cache.Insert(0, messages[0], someMatch);
+    cache.Insert(0, messages[1], someMatch);
+    CHECK(IsCached(cache, 0, messages[0]));
+    cache.Insert(0, messages[2], someMatch);
+    CHECK(IsCached(cache, 0, messages[0]));
+    CHECK(!IsCached(cache, 0, messages[1]));
+    CHECK(IsCached(cache, 0, messages[2]));
+
+    // inserting an entry which is already cached does not evict anything
+    cache.Insert(0, messages[2], someMatch);
+    CHECK(IsCached(cache, 0, messages[0]));
+    cache.Insert(0, messages[3], someMatch);
+    CHECK(!IsCached(cache, 0, messages[2]));
+    CHECK(IsCached(cache, 0, messages[0]));
+    CHECK(IsCached(cache, 0, messages[3]));
+}
+
+static void TestFullCacheDoesNotAllocate()
+{
+    std::vector<std::string> messages;
+    for (size_t i = 0; i < 2000; ++i)
+        messages.push_back("MESSAGE " + std::to_string(i) + std::string(i % maxCachedMessageLength, 'X'));
+
+    // fill all shards, afterwards every miss evicts an entry
+    MatchCache cache(64);
+    for (const std::string &message : messages)
+        cache.Insert(0, message, someMatch);
+
+    size_t numAllocationsBefore = numAllocations;
+    for (uint32_t node = 1; node < 4; ++node)
+    {
+        for (const std::string &message : messages)
+        {
+            if (!IsCached(cache, node, message))
+                cache.Insert(node, message, someMatch);
+        }
+    }
+    CHECK_EQUAL(numAllocations - numAllocationsBefore, 0u);
+}
+
+int main()
+{
+    TestHitsAndMisses();
+    TestEviction();
+    TestFullCacheDoesNotAllocate();
+    return GetTestResult();
+}
@@ -0,0 +1,45 @@
+#include <string>
+#include <sstream>
+#include "metrics.h"
+#include "testing.h"
+
+// bucket bounds are inclusive, so a value equal to a power of two is counted below that bound
+
+static bool Contains(const std::string &text, const std::string &line)
+{
+    return text.find(line + "\n") != std::string::npos;
+}
+
+int main()
+{
+    SetMetricsEnabled(true);
+    ResetMetrics();
+    for (uint64_t value : {0, 1, 2, 4, 8, 8, 9})
+        RecordValue(MetricHistogram::MatchCandidates, value);
+    AddToCounter(MetricCounter::KeywordsScored, 32);
+
+    std::ostringstream prometheus;
+    WriteMetricsPrometheus(prometheus);
+    std::string text = prometheus.str();
+    CHECK(Contains(text, "membot_keywords_scored_total 32"));
+    CHECK(Contains(text, "membot_match_candidates_bucket{le=\"1\"} 2"));
+    CHECK(Contains(text, "membot_match_candidates_bucket{le=\"2\"} 3"));
+    CHECK(Contains(text, "membot_match_candidates_bucket{le=\"4\"} 4"));
+    CHECK(Contains(text, "membot_match_candidates_bucket{le=\"8\"} 6"));
+    CHECK(Contains(text, "membot_match_candidates_bucket{le=\"16\"} 7"));
+    CHECK(Contains(text, "membot_match_candidates_bucket{le=\"+Inf\"} 7"));
+    CHECK(Contains(text, "membot_match_candidates_sum 32"));
+    CHECK(Contains(text, "membot_match_candidates_count 7"));
+
+    // JSON has the same cumulative buckets, up to the highest non-empty one
+    std::ostringstream json;
+    WriteMetricsJson(json);
+    CHECK(json.str().find("\"membot_match_candidates\": {\"count\": 7, \"sum\": 32, \"buckets\": [{\"le\": 1, \"count\": 2}, {\"le\": 2, \"count\": 3}, "
+                          "{\"le\": 4, \"count\": 4}, {\"le\": 8, \"count\": 6}, {\"le\": 16, \"count\": 7}]}") != std::string::npos);
+
+    ResetMetrics();
+    std::ostringstream reset;
+    WriteMetricsPrometheus(reset);
+    CHECK(Contains(reset.str(), "membot_match_candidates_count 0"));
+    return GetTestResult();
+}
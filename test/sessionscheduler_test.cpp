@@ -0,0 +1,146 @@
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include "answergraph.h"
+#include "graphpublisher.h"
+#include "chatsession.h"
+#include "sessionscheduler.h"
+#include "pcg32.h"
+#include "testing.h"
+
+// per-session message order on several workers, closing sessions and discarding messages on shutdown
+
+// every node of the shipped graph has a single answer, so the answers of a session only depend on its messages
+static const char *const messages[] = {"pointer", "smart pointer", "nullptr", "weak pointer", "memory model", "heap", "stack", "static", "", "something else"};
+const size_t numMessages = sizeof(messages) / sizeof(messages[0]);
+
+static std::shared_ptr<const GraphPublisher> LoadPublisher()
+{
+    auto graph = std::make_shared<AnswerGraph>();
+    if (!graph->LoadFromFile(MEMBOT_SOURCE_DIR "/src/answergraph.txt"))
+        return nullptr;
+
+    auto publisher = std::make_shared<GraphPublisher>();
+    publisher->Publish(graph);
+    return publisher;
+}
+
+// answers of a session which receives the messages one after the other
+static std::vector<std::string> GetExpectedAnswers(std::shared_ptr<const GraphPublisher> publisher, const std::vector<std::string> &script)
+{
+    ChatSession session(publisher, 0);
+    session.Start();
+    std::vector<std::string> answers;
+    for (const std::string &message : script)
+        answers.emplace_back(message.empty() ? session.Start() : session.ReceiveMessage(message));
+    return answers;
+}
+
+static void TestMessageOrder(std::shared_ptr<const GraphPublisher> publisher)
+{
+    const size_t numSessions = 300;
+    const size_t numMessagesPerSession = 40;
+    const size_t numProducers = 3;
+
+    Pcg32 generator(7);
+    std::vector<std::vector<std::string>> scripts(numSessions);
+    for (std::vector<std::string> &script : scripts)
+    {
+        for (size_t m = 0; m < numMessagesPerSession; ++m)
+            script.emplace_back(messages[generator() % numMessages]);
+    }
+
+    std::mutex answerMutex;
+    std::unordered_map<std::string, std::vector<std::string>> answers;
+    {
+        SessionScheduler scheduler(publisher, 4, [&](const std::string &sessionId, std::string_view answer) {
+            std::lock_guard<std::mutex> lock(answerMutex);
+            answers[sessionId].emplace_back(answer);
+        });
+
+        // every producer posts the messages of its sessions round-robin, so the sessions interleave in all queues
+        std::vector<std::thread> producers;
+        for (size_t p = 0; p < numProducers; ++p)
+        {
+            producers.emplace_back([&scheduler, &scripts, p]() {
+                for (size_t m = 0; m < numMessagesPerSession; ++m)
+                {
+                    for (size_t s = p; s < numSessions; s += numProducers)
+                        scheduler.PostMessage("session" + std::to_string(s), scripts[s][m]);
+                }
+            });
+        }
+        for (std::thread &producer : producers)
+            producer.join();
+        scheduler.WaitUntilIdle();
+    }
+
+    CHECK_EQUAL(answers.size(), numSessions);
+    for (size_t s = 0; s < numSessions; ++s)
+        CHECK(answers["session" + std::to_string(s)] == GetExpectedAnswers(publisher, scripts[s]));
+}
+
+static void TestCloseSession(std::shared_ptr<const GraphPublisher> publisher)
+{
+    std::mutex answerMutex;
+    std::vector<std::string> answers;
+    SessionScheduler scheduler(publisher, 2, [&](const std::string &, std::string_view answer) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(answerMutex);
+        answers.emplace_back(answer);
+    });
+
+    // closing discards the pending messages, so waiting does not take the time of answering them all
+    for (size_t m = 0; m < 2000; ++m)
+        scheduler.PostMessage("closed", "pointer");
+    scheduler.CloseSession("closed");
+    scheduler.CloseSession("unknown");
+    scheduler.WaitUntilIdle();
+    {
+        std::lock_guard<std::mutex> lock(answerMutex);
+        CHECK(answers.size() < 2000);
+        answers.clear();
+    }
+
+    // the same ID starts over at the root node
+    scheduler.PostMessage("closed", "pointer");
+    scheduler.PostMessage("closed", "nullptr");
+    scheduler.WaitUntilIdle();
+    CHECK(answers == GetExpectedAnswers(publisher, {"pointer", "nullptr"}));
+}
+
+static void TestShutdown(std::shared_ptr<const GraphPublisher> publisher)
+{
+    std::atomic<size_t> numAnswers(0);
+    {
+        SessionScheduler scheduler(publisher, 2, [&numAnswers](const std::string &, std::string_view) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            numAnswers++;
+        });
+        for (size_t s = 0; s < 20; ++s)
+        {
+            for (size_t m = 0; m < 100; ++m)
+                scheduler.PostMessage("session" + std::to_string(s), messages[m % numMessages]);
+        }
+        scheduler.CloseSession("session0"); // possibly still queued, deleted by a worker during shutdown
+    }
+    CHECK(numAnswers < 2000);
+}
+
+int main()
+{
+    std::shared_ptr<const GraphPublisher> publisher = LoadPublisher();
+    CHECK(publisher != nullptr);
+    if (publisher == nullptr)
+        return GetTestResult();
+
+    TestMessageOrder(publisher);
+    TestCloseSession(publisher);
+    TestShutdown(publisher);
+    return GetTestResult();
+}
@@ -0,0 +1,46 @@
+#ifndef TESTING_H_
+#define TESTING_H_
+
+#include <iostream>
+
+// minimal checks for the test executables run by ctest
+// a failed check is reported with its location and the test keeps going, GetTestResult is returned from main
+
+inline int &GetNumberOfFailedChecks()
+{
+    static int numFailedChecks = 0;
+    return numFailedChecks;
+}
+
+#define CHECK(condition)                                                                         \
+    do                                                                                           \
+    {                                                                                            \
+        if (!(condition))                                                                        \
+        {                                                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            ++GetNumberOfFailedChecks();                                                         \
+        }                                                                                        \
+    } while (false)
+
+// both arguments are evaluated exactly once, so checks may call functions with side effects
+#define CHECK_EQUAL(actual, expected)                                                                                     \
+    do                                                                                                                    \
+    {                                                                                                                     \
+        const auto &actualValue = (actual);                                                                               \
+        const auto &expectedValue = (expected);                                                                           \
+        if (!(actualValue == expectedValue))                                                                              \
+        {                                                                                                                 \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #actual " == " #expected " (" << actualValue \
+                      << " != " << expectedValue << ")" << std::endl;                                                     \
+            ++GetNumberOfFailedChecks();                                                                                  \
+        }                                                                                                                 \
+    } while (false)
+
+inline int GetTestResult()
+{
+    if (GetNumberOfFailedChecks() > 0)
+        std::cerr << GetNumberOfFailedChecks() << " check(s) failed" << std::endl;
+    return GetNumberOfFailedChecks() > 0 ? 1 : 0;
+}
+
+#endif /* TESTING_H_ */
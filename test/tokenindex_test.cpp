@@ -0,0 +1,117 @@
+#include <string>
+#include <vector>
+#include <initializer_list>
+#include "answergraph.h"
+#include "tokenindex.h"
+#include "testing.h"
+
+// distances by missing words, the choice among equally close keywords, the fallback to message matching,
+// and the token index of a text file is built while loading (or when token matching is switched on), not by a message
+
+// normalized keyword table with one keyword per edge
+struct KeywordTable
+{
+    std::string strings;
+    std::vector<ImageKeyword> entries;
+    std::vector<GraphEdge> edges;
+
+    explicit KeywordTable(std::initializer_list<const char *> keywords)
+    {
+        for (std::string_view keyword : keywords)
+        {
+            uint32_t edge = edges.size();
+            entries.push_back(ImageKeyword{ImageString{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(keyword.size())}, edge});
+            edges.push_back(GraphEdge(edge, 0, edge + 1));
+            strings += keyword;
+        }
+    }
+
+    KeywordIndex GetIndex() const { return KeywordIndex(entries.data(), entries.size(), strings.data(), edges.data()); }
+};
+
+static void CheckMatch(const KeywordTable &table, const TokenIndex &index, uint32_t first, uint32_t count, std::string_view query, int edge, int distance)
+{
+    KeywordMatch match = index.FindBestMatch(table.GetIndex(), first, count, query);
+    if (edge < 0)
+    {
+        CHECK(match.edge == nullptr);
+        return;
+    }
+    CHECK(match.edge == &table.edges[edge]);
+    CHECK_EQUAL(match.distance, distance);
+}
+
+static void TestTokenMatching()
+{
+    KeywordTable table{"SMART POINTER", "POINTER", "NULL POINTER", "HEAP MEMORY", "STACK", "MEMORY HEAP", "HEAP"};
+    TokenIndex index;
+    index.Build(table.GetIndex());
+    CHECK_EQUAL(index.GetNumberOfTokens(), 6u);
+    CHECK(index.GetMemoryUsage() > 0);
+
+    uint32_t all = table.entries.size();
+    CheckMatch(table, index, 0, all, "WHAT IS A SMART POINTER", 0, 0); // more words found wins among complete keywords
+    CheckMatch(table, index, 0, all, "POINTER", 1, 0);
+    CheckMatch(table, index, 0, all, "POINTER?", 1, 0);                // punctuation separates words
+    CheckMatch(table, index, 0, all, "NULL", 2, 1);                    // distance is the number of missing words
+    CheckMatch(table, index, 0, all, "MEMORY, STACK", 4, 0);
+    CheckMatch(table, index, 0, all, "MEMORY", 3, 1);                  // the first of equally close keywords wins
+    CheckMatch(table, index, 0, all, "MEMORY HEAP HEAP", 3, 0);        // repeated words count once
+    CheckMatch(table, index, 0, all, "HELLO", -1, 0);                  // no shared word
+    CheckMatch(table, index, 0, all, "", -1, 0);
+
+    // only the keywords of the given range (i.e. of one node) are candidates
+    CheckMatch(table, index, 3, 2, "SMART POINTER", -1, 0);
+    CheckMatch(table, index, 3, 4, "HEAP", 6, 0);
+    CheckMatch(table, index, 4, 2, "HEAP", 5, 1);
+}
+
+// messages without any known word are matched like in message mode
+static void TestFallbackToMessageMode(const std::string &textFile)
+{
+    AnswerGraph tokens;
+    tokens.SetMatchingMode(MatchingMode::Tokens);
+    CHECK(tokens.LoadFromFile(textFile));
+    AnswerGraph message;
+    CHECK(message.LoadFromFile(textFile));
+
+    for (const char *query : {"POINTR", "HEAPS", "STATIC MEMRY", "XYZ", ""})
+    {
+        KeywordMatch expected = message.FindBestMatch(*message.GetRootNode(), query);
+        KeywordMatch actual = tokens.FindBestMatch(*tokens.GetRootNode(), query);
+        CHECK(expected.edge != nullptr && actual.edge != nullptr);
+        if (expected.edge != nullptr && actual.edge != nullptr)
+        {
+            CHECK_EQUAL(actual.edge->GetID(), expected.edge->GetID());
+            CHECK_EQUAL(actual.distance, expected.distance);
+        }
+    }
+
+    // a known word is matched by tokens: "MEMORY" is one of two words of "memory model", which is a keyword of edge 1
+    KeywordMatch match = tokens.FindBestMatch(*tokens.GetRootNode(), "TELL ME ABOUT MEMORY");
+    CHECK(match.edge != nullptr && match.edge->GetID() == 1);
+    CHECK_EQUAL(match.distance, 1);
+}
+
+static void TestIndexBuiltWhileLoading(const std::string &textFile)
+{
+    AnswerGraph tokens;
+    tokens.SetMatchingMode(MatchingMode::Tokens);
+    CHECK(tokens.LoadFromFile(textFile));
+    CHECK(tokens.GetMemoryUsage().tokenIndex > 0);
+
+    AnswerGraph message;
+    CHECK(message.LoadFromFile(textFile));
+    CHECK_EQUAL(message.GetMemoryUsage().tokenIndex, 0u);
+    message.SetMatchingMode(MatchingMode::Tokens);
+    CHECK(message.GetMemoryUsage().tokenIndex > 0);
+}
+
+int main()
+{
+    std::string textFile = MEMBOT_SOURCE_DIR "/src/answergraph.txt";
+    TestTokenMatching();
+    TestFallbackToMessageMode(textFile);
+    TestIndexBuiltWhileLoading(textFile);
+    return GetTestResult();
+}
@@ -0,0 +1,104 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "graphgenerator.h"
+
+// number of words of a generated answer
+const size_t wordsPerAnswer = 8;
+
+GraphGeneratorOptions::GraphGeneratorOptions()
+{
+    numNodes = 1000;
+    fanout = 4;
+    minWordLength = 3;
+    maxWordLength = 10;
+    maxWordsPerKeyword = 2;
+    maxKeywordsPerEdge = 2;
+    vocabularySize = 1000;
+    answersPerNode = 2;
+    cycleRatio = 0.0;
+    seed = 1;
+}
+
+static std::string MakeWord(std::mt19937 &generator, size_t length)
+{
+    static const char consonants[] = "bcdfghjklmnpqrstvwxz";
+    static const char vowels[] = "aeiouy";
+
+    std::string word(length, 'a');
+    for (size_t i = 0; i < length; ++i)
+        word[i] = i % 2 == 0 ? consonants[generator() % (sizeof(consonants) - 1)] : vowels[generator() % (sizeof(vowels) - 1)];
+    return word;
+}
+
+// random words from the vocabulary, separated by spaces
+static void AppendWords(const std::vector<std::string> &vocabulary, size_t count, std::mt19937 &generator, std::string &text)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+            text.push_back(' ');
+        text.append(vocabulary[generator() % vocabulary.size()]);
+    }
+}
+
+void GenerateGraph(const GraphGeneratorOptions &options, std::ostream &output)
+{
+    std::mt19937 generator(options.seed);
+    size_t minWordLength = std::max<size_t>(1, options.minWordLength);
+    size_t maxWordLength = std::max(minWordLength, options.maxWordLength);
+    size_t fanout = std::max<size_t>(1, options.fanout);
+    std::uniform_int_distribution<size_t> wordLength(minWordLength, maxWordLength);
+    std::uniform_int_distribution<size_t> wordsPerKeyword(1, std::max<size_t>(1, options.maxWordsPerKeyword));
+    std::uniform_int_distribution<size_t> keywordsPerEdge(1, std::max<size_t>(1, options.maxKeywordsPerEdge));
+    std::bernoulli_distribution hasCycle(std::min(1.0, std::max(0.0, options.cycleRatio)));
+
+    std::vector<std::string> vocabulary(std::max<size_t>(1, options.vocabularySize));
+    for (std::string &word : vocabulary)
+        word = MakeWord(generator, wordLength(generator));
+
+    // nodes
+    std::string line;
+    for (size_t i = 0; i < options.numNodes; ++i)
+    {
+        line = "<TYPE:NODE><ID:" + std::to_string(i) + ">";
+        for (size_t j = 0; j < options.answersPerNode; ++j)
+        {
+            line.append("<ANSWER:");
+            AppendWords(vocabulary, wordsPerAnswer, generator, line);
+            line.push_back('>');
+        }
+        output << line << '\n';
+    }
+
+    // edges, the parent of node i is (i - 1) / fanout, so the nodes are numbered in breadth-first order
+    size_t edgeId = 0;
+    auto writeEdge = [&](size_t parent, size_t child) {
+        line = "<TYPE:EDGE><ID:" + std::to_string(edgeId++) + "><PARENT:" + std::to_string(parent) + "><CHILD:" + std::to_string(child) + ">";
+        size_t numKeywords = keywordsPerEdge(generator);
+        for (size_t k = 0; k < numKeywords; ++k)
+        {
+            line.append("<KEYWORD:");
+            AppendWords(vocabulary, wordsPerKeyword(generator), generator, line);
+            line.push_back('>');
+        }
+        output << line << '\n';
+    };
+
+    for (size_t i = 1; i < options.numNodes; ++i)
+    {
+        writeEdge((i - 1) / fanout, i);
+
+        // cycle back to an ancestor, chosen uniformly along the path to the root
+        // (the root itself is left out, as it is identified by having no parents)
+        if (hasCycle(generator))
+        {
+            std::vector<size_t> ancestors;
+            for (size_t node = (i - 1) / fanout; node != 0; node = (node - 1) / fanout)
+                ancestors.push_back(node);
+            if (!ancestors.empty())
+                writeEdge(i, ancestors[generator() % ancestors.size()]);
+        }
+    }
+}
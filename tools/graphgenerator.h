@@ -0,0 +1,29 @@
+#ifndef GRAPHGENERATOR_H_
+#define GRAPHGENERATOR_H_
+
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+// parameters of a synthetic answer graph (see GenerateGraph)
+struct GraphGeneratorOptions
+{
+    size_t numNodes;
+    size_t fanout;             // number of children of every inner node
+    size_t minWordLength;      // word lengths are distributed uniformly between both bounds
+    size_t maxWordLength;
+    size_t maxWordsPerKeyword; // keywords consist of 1 to maxWordsPerKeyword words
+    size_t maxKeywordsPerEdge; // edges have 1 to maxKeywordsPerEdge keywords
+    size_t vocabularySize;     // number of distinct words, so keywords recur across edges like in real graphs
+    size_t answersPerNode;
+    double cycleRatio; // share of nodes with an additional edge back to one of their ancestors (other than the root)
+    uint32_t seed;
+
+    GraphGeneratorOptions();
+};
+
+// write a graph in the answer graph file format: a tree with node 0 as root, every inner node has fanout children,
+// plus the edges closing cycles; words are made of alternating consonants and vowels, so they look like real words
+void GenerateGraph(const GraphGeneratorOptions &options, std::ostream &output);
+
+#endif /* GRAPHGENERATOR_H_ */
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include "graphparser.h"
+#include "graphimage.h"
+#include "mappedfile.h"
+
+// check every index of an image of unknown origin, as loading an image trusts its tables (see GraphImage)
+static int CheckImage(const char *filename)
+{
+    MappedFile file;
+    GraphImage image;
+    if (!file.Open(filename) || !image.Open(file.GetContent()) || !image.Validate())
+    {
+        std::cout << filename << " is not a valid graph image" << std::endl;
+        return 1;
+    }
+
+    std::cout << filename << " is valid" << std::endl;
+    return 0;
+}
+
+// offline graph compiler: turns an answer graph text file into a binary image which membot opens without parsing
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && std::string(argv[1]) == "--check")
+        return CheckImage(argv[2]);
+
+    if (argc != 3)
+    {
+        std::cout << "Usage: membotc <answergraph.txt> <answergraph.img>" << std::endl;
+        std::cout << "       membotc --check <answergraph.img>" << std::endl;
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(argv[1]))
+    {
+        std::cout << "File could not be opened!" << std::endl;
+        return 1;
+    }
+
+    // parse the text file on all cores and hand the records to the builder
+    GraphRecordTable records;
+    ParseGraphRecords(file.GetContent(), std::thread::hardware_concurrency(), records);
+
+    GraphImageBuilder builder;
+    builder.AddRecords(records);
+
+    if (!builder.Write(argv[2]))
+        return 1;
+
+    std::cout << "Compiled " << builder.GetNumberOfNodes() << " nodes and " << builder.GetNumberOfEdges() << " edges ("
+              << builder.GetStringPoolSize() << " bytes in " << builder.GetNumberOfStrings() << " distinct strings) into " << argv[2] << std::endl;
+    return 0;
+}
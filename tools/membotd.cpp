@@ -0,0 +1,369 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <unordered_set>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include "answergraph.h"
+#include "graphpublisher.h"
+#include "chatserver.h"
+#include "metrics.h"
+
+#ifndef _WIN32
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+// headless front-end: answers newline-delimited requests "<session id>\t<message>" with lines "<session id>\t<answer>"
+// requests are read from stdin or from TCP clients; all requests which are available at once form one batch,
+// so many sessions are answered in parallel per tick while each session sees its answers in order
+// sessions which have been idle for --idle-timeout seconds are closed, as are the sessions of a disconnected client;
+// after a reload, sessions waiting at the root node are moved to the new graph, so the old one is released early
+// on POSIX systems, SIGHUP reloads the answer graph file without interrupting the sessions
+// with --metrics, a snapshot of all metrics is written to a file periodically (JSON if its name ends with .json,
+// the Prometheus text format otherwise, e.g. for the textfile collector of the node exporter)
+
+// upper bound for the number of requests answered per tick, keeps the latency of a tick bounded
+const size_t maxBatchSize = 4096;
+
+// time between two metrics snapshots
+const std::chrono::seconds metricsInterval(10);
+
+// sessions are checked for expiry at most this often, as the check visits all sessions
+const std::chrono::seconds idleCheckInterval(10);
+
+// split a request line into session id and message, returns false if there is no separator
+static bool ParseRequest(std::string_view line, ChatRequest &request)
+{
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    size_t posSeparator = line.find('\t');
+    if (posSeparator == std::string_view::npos)
+        return false;
+
+    request.sessionId.assign(line.data(), posSeparator);
+    request.message.assign(line.data() + posSeparator + 1, line.size() - posSeparator - 1);
+    return true;
+}
+
+static void AppendResponse(const ChatResponse &response, std::string &output)
+{
+    output.append(response.sessionId);
+    output.push_back('\t');
+    output.append(response.answer);
+    output.push_back('\n');
+}
+
+// load a graph which is ready to be published, nullptr on errors
+static std::shared_ptr<const AnswerGraph> LoadGraph(const std::string &filename, MatchingMode matchingMode)
+{
+    std::shared_ptr<AnswerGraph> graph = std::make_shared<AnswerGraph>();
+    graph->SetMatchingMode(matchingMode);
+    if (!graph->LoadFromFile(filename) || graph->GetRootNode() == nullptr)
+    {
+        std::cerr << "Error: Answer graph could not be loaded!" << std::endl;
+        return nullptr;
+    }
+
+    return graph;
+}
+
+// replace the metrics file periodically, readers never see a partially written file
+static void WriteMetricsPeriodically(std::string filename)
+{
+    bool isJson = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+    std::string tempFilename = filename + ".tmp";
+    while (true)
+    {
+        std::this_thread::sleep_for(metricsInterval);
+        {
+            std::ofstream file(tempFilename, std::ios::trunc);
+            if (isJson)
+                WriteMetricsJson(file);
+            else
+                WriteMetricsPrometheus(file);
+            if (!file)
+            {
+                std::cerr << "Error: Metrics could not be written to " << tempFilename << "!" << std::endl;
+                continue;
+            }
+        }
+        std::rename(tempFilename.c_str(), filename.c_str());
+    }
+}
+
+// release the sessions which hold on to an old graph or have been idle for too long (a timeout of 0 keeps all sessions)
+static void ExpireIdleSessions(ChatServer &server, std::chrono::seconds idleTimeout, std::chrono::steady_clock::time_point &nextCheckTime)
+{
+    server.MoveIdleSessionsToPublishedGraph();
+    if (idleTimeout.count() == 0 || std::chrono::steady_clock::now() < nextCheckTime)
+        return;
+
+    server.CloseIdleSessions(idleTimeout);
+    nextCheckTime = std::chrono::steady_clock::now() + idleCheckInterval;
+}
+
+static int ServeStdin(ChatServer &server, std::chrono::seconds idleTimeout, std::ostream &output)
+{
+    std::chrono::steady_clock::time_point nextCheckTime = std::chrono::steady_clock::now() + idleCheckInterval;
+    std::vector<ChatRequest> requests;
+    std::vector<ChatResponse> responses;
+    std::string line, outputBuffer;
+    ChatRequest request;
+    while (std::getline(std::cin, line))
+    {
+        // wait for one request, then take everything else which has already arrived into the same batch
+        requests.clear();
+        do
+        {
+            if (ParseRequest(line, request))
+                requests.push_back(request);
+            else if (!line.empty())
+                std::cerr << "Error: Request without session id. Line is ignored!" << std::endl;
+        } while (requests.size() < maxBatchSize && std::cin.rdbuf()->in_avail() > 0 && std::getline(std::cin, line));
+
+        server.ProcessBatch(requests, responses);
+
+        // write all responses of a tick at once
+        outputBuffer.clear();
+        for (const ChatResponse &response : responses)
+            AppendResponse(response, outputBuffer);
+        output.write(outputBuffer.data(), outputBuffer.size());
+        output.flush();
+
+        ExpireIdleSessions(server, idleTimeout, nextCheckTime);
+    }
+
+    return 0;
+}
+
+#ifndef _WIN32
+// wait for SIGHUP and publish a freshly loaded graph every time it arrives (the signal is blocked in all other threads)
+static void WatchReloadSignal(std::shared_ptr<GraphPublisher> publisher, std::string filename, MatchingMode matchingMode)
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+
+    int signal;
+    while (sigwait(&signals, &signal) == 0)
+    {
+        std::shared_ptr<const AnswerGraph> graph = LoadGraph(filename, matchingMode);
+        if (graph == nullptr)
+            continue;
+
+        publisher->Publish(std::move(graph));
+        std::cerr << "Answer graph reloaded" << std::endl;
+    }
+}
+
+// write the complete buffer to a (blocking) socket
+static bool SendAll(int socket, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t count = send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0)
+            return false;
+        sent += count;
+    }
+    return true;
+}
+
+static int ServeSocket(ChatServer &server, int port, std::chrono::seconds idleTimeout)
+{
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0)
+    {
+        std::cerr << "Error: Port " << port << " could not be opened!" << std::endl;
+        return 1;
+    }
+    std::cerr << "Listening on port " << port << std::endl;
+
+    // connected clients with the incomplete last line they have sent so far and the sessions they have used
+    struct Client
+    {
+        int socket;
+        std::string input;
+        std::string output;
+        std::unordered_set<std::string> sessionIds;
+    };
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    std::vector<ChatRequest> requests;
+    std::vector<size_t> requestClients; // client index of every request
+    std::vector<ChatResponse> responses;
+    ChatRequest request;
+    char buffer[65536];
+    std::chrono::steady_clock::time_point nextCheckTime = std::chrono::steady_clock::now() + idleCheckInterval;
+
+    while (true)
+    {
+        fds.clear();
+        fds.push_back(pollfd{listener, POLLIN, 0});
+        for (const Client &client : clients)
+            fds.push_back(pollfd{client.socket, POLLIN, 0});
+        // poll wakes up in time for the expiry check (and after reloads), even if no client sends anything
+        int timeout = static_cast<int>(std::chrono::milliseconds(idleCheckInterval).count());
+        int numReady = poll(fds.data(), fds.size(), timeout);
+        ExpireIdleSessions(server, idleTimeout, nextCheckTime);
+        if (numReady <= 0)
+            continue;
+
+        // collect the requests of all clients which have sent data
+        requests.clear();
+        requestClients.clear();
+        for (size_t i = 0; i < clients.size(); ++i)
+        {
+            if ((fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+                continue;
+
+            ssize_t count = recv(clients[i].socket, buffer, sizeof(buffer), 0);
+            if (count <= 0)
+            {
+                close(clients[i].socket);
+                clients[i].socket = -1;
+                continue;
+            }
+
+            // complete lines become requests, the rest waits for the next tick
+            Client &client = clients[i];
+            client.input.append(buffer, count);
+            size_t lineStart = 0, lineEnd;
+            while ((lineEnd = client.input.find('\n', lineStart)) != std::string::npos)
+            {
+                if (ParseRequest(std::string_view(client.input).substr(lineStart, lineEnd - lineStart), request))
+                {
+                    client.sessionIds.insert(request.sessionId);
+                    requests.push_back(request);
+                    requestClients.push_back(i);
+                }
+                lineStart = lineEnd + 1;
+            }
+            client.input.erase(0, lineStart);
+        }
+
+        if (!requests.empty())
+        {
+            server.ProcessBatch(requests, responses);
+            for (size_t i = 0; i < responses.size(); ++i)
+                AppendResponse(responses[i], clients[requestClients[i]].output);
+            for (Client &client : clients)
+            {
+                if (client.socket >= 0 && !client.output.empty() && !SendAll(client.socket, client.output))
+                {
+                    close(client.socket);
+                    client.socket = -1;
+                }
+                client.output.clear();
+            }
+        }
+
+        // remove disconnected clients together with their sessions and accept new ones
+        for (const Client &client : clients)
+        {
+            if (client.socket < 0)
+            {
+                for (const std::string &sessionId : client.sessionIds)
+                    server.CloseSession(sessionId);
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(), [](const Client &client) { return client.socket < 0; }), clients.end());
+        if (fds[0].revents & POLLIN)
+        {
+            int clientSocket = accept(listener, nullptr, nullptr);
+            if (clientSocket >= 0)
+                clients.push_back(Client{clientSocket, std::string(), std::string(), std::unordered_set<std::string>()});
+        }
+    }
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: membotd <answergraph> [--port <port>] [--threads <count>] [--matching message|tokens] [--metrics <file>] [--idle-timeout <seconds>]" << std::endl;
+        return 1;
+    }
+
+    int port = 0;
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    MatchingMode matchingMode = MatchingMode::Message;
+    std::string metricsFilename;
+    std::chrono::seconds idleTimeout(1800);
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--port") == 0)
+            port = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            numThreads = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--matching") == 0)
+            matchingMode = std::strcmp(argv[i + 1], "tokens") == 0 ? MatchingMode::Tokens : MatchingMode::Message;
+        else if (std::strcmp(argv[i], "--metrics") == 0)
+            metricsFilename = argv[i + 1];
+        else if (std::strcmp(argv[i], "--idle-timeout") == 0)
+            idleTimeout = std::chrono::seconds(std::max(0, std::atoi(argv[i + 1])));
+    }
+
+    // metrics are enabled before loading, so the load phases of the initial graph are recorded as well
+    SetMetricsEnabled(!metricsFilename.empty());
+
+    // unsynchronized streams are required for in_avail to see buffered input (switching replaces the stream buffers,
+    // so this has to be done before the redirection below)
+    std::ios::sync_with_stdio(false);
+
+    // loading diagnostics (also of reloads) are redirected to stderr, as stdout carries the responses
+    std::ostream responseOutput(std::cout.rdbuf(std::cerr.rdbuf()));
+
+    // the graph is shared by all sessions, until it is replaced by a reload
+    std::shared_ptr<GraphPublisher> publisher = std::make_shared<GraphPublisher>();
+    std::shared_ptr<const AnswerGraph> graph = LoadGraph(argv[1], matchingMode);
+    if (graph == nullptr)
+        return 1;
+    publisher->Publish(std::move(graph));
+
+#ifndef _WIN32
+    // block SIGHUP before any other thread is started, so only the watcher receives it
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread(WatchReloadSignal, publisher, std::string(argv[1]), matchingMode).detach();
+#endif
+
+    if (!metricsFilename.empty())
+        std::thread(WriteMetricsPeriodically, metricsFilename).detach();
+
+    ChatServer server(publisher, numThreads);
+
+    if (port == 0)
+        return ServeStdin(server, idleTimeout, responseOutput);
+
+#ifndef _WIN32
+    return ServeSocket(server, port, idleTimeout);
+#else
+    std::cerr << "Error: Socket mode is not available on this platform!" << std::endl;
+    return 1;
+#endif
+}
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include "graphgenerator.h"
+
+// generator of synthetic answer graphs in the text format, e.g. for sizing hardware with membotload
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: membotgen <output file> [--nodes <count>] [--fanout <count>] [--word-length <min> <max>]" << std::endl;
+        std::cout << "                 [--words-per-keyword <max>] [--keywords-per-edge <max>] [--vocabulary <words>]" << std::endl;
+        std::cout << "                 [--answers <count>] [--cycles <share of nodes>] [--seed <value>]" << std::endl;
+        return 1;
+    }
+
+    GraphGeneratorOptions options;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--nodes") == 0)
+            options.numNodes = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--fanout") == 0)
+            options.fanout = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--word-length") == 0 && i + 2 < argc)
+        {
+            options.minWordLength = std::strtoull(argv[i + 1], nullptr, 10);
+            options.maxWordLength = std::strtoull(argv[++i + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--words-per-keyword") == 0)
+            options.maxWordsPerKeyword = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--keywords-per-edge") == 0)
+            options.maxKeywordsPerEdge = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--vocabulary") == 0)
+            options.vocabularySize = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--answers") == 0)
+            options.answersPerNode = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--cycles") == 0)
+            options.cycleRatio = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            options.seed = std::strtoul(argv[i + 1], nullptr, 10);
+        else
+        {
+            std::cout << "Error: Unknown option " << argv[i] << "!" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream file(argv[1], std::ios::trunc);
+    if (!file)
+    {
+        std::cout << "File could not be opened!" << std::endl;
+        return 1;
+    }
+
+    GenerateGraph(options, file);
+    return file ? 0 : 1;
+}
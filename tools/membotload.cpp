@@ -0,0 +1,157 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include "answergraph.h"
+#include "chatlogic.h"
+
+// load-test driver: simulated users talk to the session scheduler of ChatLogic and the latency of every answer is measured
+// every session sends its next message as soon as it has received the answer to the previous one (closed loop),
+// so the number of sessions controls the load and the driver reports the sustainable throughput
+
+typedef std::chrono::steady_clock Clock;
+
+// conversation of one simulated user, prepared before the test so that generating messages is not measured
+struct SimulatedSession
+{
+    std::string id;
+    std::vector<std::string> messages;
+    std::vector<Clock::time_point> sendTimes; // sendTimes[i] is written before messages[i] is posted
+    std::vector<double> latencies;            // in microseconds, only written by the worker answering the session
+};
+
+// random walk through the graph: follow a child edge by one of its keywords (sometimes with a typo),
+// leaf nodes have no keywords, so any message sends the session back to the root node
+static void MakeMessages(const AnswerGraph &graph, size_t count, double typoRate, std::mt19937 &generator, std::vector<std::string> &messages)
+{
+    std::bernoulli_distribution hasTypo(typoRate);
+    const GraphNode *node = graph.GetRootNode();
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (node->GetNumberOfChildEdges() == 0)
+        {
+            messages.push_back("#");
+            node = graph.GetRootNode();
+            continue;
+        }
+
+        const GraphEdge *edge = graph.GetChildEdge(*node, generator() % node->GetNumberOfChildEdges());
+        std::string message = edge->GetNumberOfKeywords() > 0 ? std::string(graph.GetKeyword(*edge, generator() % edge->GetNumberOfKeywords())) : "#";
+        if (hasTypo(generator) && !message.empty())
+            message[generator() % message.size()] = 'a' + generator() % 26;
+        messages.push_back(message);
+        node = graph.GetChildNode(*edge);
+    }
+}
+
+static double GetPercentile(std::vector<double> &values, double percentile)
+{
+    if (values.empty())
+        return 0.0;
+
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: membotload <answergraph> [--sessions <count>] [--messages <per session>] [--threads <count>] [--typos <rate>] [--seed <value>]" << std::endl;
+        return 1;
+    }
+
+    size_t numSessions = 1000;
+    size_t numMessages = 100;
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    double typoRate = 0.1;
+    uint32_t seed = 1;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--sessions") == 0)
+            numSessions = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--messages") == 0)
+            numMessages = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            numThreads = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--typos") == 0)
+            typoRate = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            seed = std::strtoul(argv[i + 1], nullptr, 10);
+    }
+
+    ChatLogic chatLogic;
+    chatLogic.SetResponseCallback([](const std::string &) {}); // the welcome of the chatbot is not needed
+    auto loadStart = Clock::now();
+    chatLogic.LoadAnswerGraphFromFile(argv[1]);
+    std::shared_ptr<const AnswerGraph> graph = chatLogic.GetAnswerGraph();
+    if (graph == nullptr)
+    {
+        std::cout << "Error: Answer graph could not be loaded!" << std::endl;
+        return 1;
+    }
+    std::cout << "graph: " << graph->GetNumberOfNodes() << " nodes, " << graph->GetNumberOfEdges() << " edges, loaded in "
+              << std::chrono::duration<double>(Clock::now() - loadStart).count() << " s" << std::endl;
+
+    std::mt19937 generator(seed);
+    std::vector<SimulatedSession> sessions(numSessions);
+    for (size_t i = 0; i < numSessions; ++i)
+    {
+        sessions[i].id = std::to_string(i);
+        MakeMessages(*graph, numMessages, typoRate, generator, sessions[i].messages);
+        sessions[i].sendTimes.resize(numMessages);
+        sessions[i].latencies.reserve(numMessages);
+    }
+
+    // session ids are the indices into sessions, so the callback finds a session without any lookup table
+    // the messages of a session are answered in order, so the number of latencies is the index of the answered message
+    auto sendMessage = [&chatLogic](SimulatedSession &session, size_t index) {
+        session.sendTimes[index] = Clock::now();
+        chatLogic.SendMessageToSession(session.id, session.messages[index]);
+    };
+    chatLogic.StartSessionScheduler(numThreads, [&sessions, &sendMessage](const std::string &sessionId, std::string_view) {
+        SimulatedSession &session = sessions[std::strtoull(sessionId.c_str(), nullptr, 10)];
+        size_t index = session.latencies.size();
+        session.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - session.sendTimes[index]).count());
+        if (index + 1 < session.messages.size())
+            sendMessage(session, index + 1);
+    });
+
+    auto testStart = Clock::now();
+    for (SimulatedSession &session : sessions)
+    {
+        if (!session.messages.empty())
+            sendMessage(session, 0);
+    }
+    chatLogic.WaitForSessions();
+    double duration = std::chrono::duration<double>(Clock::now() - testStart).count();
+    chatLogic.StopSessionScheduler();
+
+    std::vector<double> latencies;
+    latencies.reserve(numSessions * numMessages);
+    for (const SimulatedSession &session : sessions)
+        latencies.insert(latencies.end(), session.latencies.begin(), session.latencies.end());
+
+    std::cout << "sessions: " << numSessions << ", messages: " << latencies.size() << ", threads: " << numThreads << std::endl;
+    std::cout << "throughput: " << latencies.size() / duration << " messages/s" << std::endl;
+    std::cout << "latency p50: " << GetPercentile(latencies, 0.5) << " us, p99: " << GetPercentile(latencies, 0.99)
+              << " us, p999: " << GetPercentile(latencies, 0.999) << " us" << std::endl;
+    std::cout << "match cache: " << graph->GetMatchCache().GetNumberOfHits() << " hits, " << graph->GetMatchCache().GetNumberOfMisses() << " misses" << std::endl;
+
+    // the footprint is reported after the test, so it includes a filled match cache
+    GraphMemoryUsage usage = graph->GetMemoryUsage();
+    std::cout << "memory: " << usage.GetTotal() << " bytes (nodes " << usage.nodes << ", edges " << usage.edges << ", answers " << usage.answers
+              << ", keywords " << usage.keywords << ", strings " << usage.strings << ", keyword trees " << usage.keywordTrees
+              << ", token index " << usage.tokenIndex << ", match cache " << usage.matchCache << "), tables "
+              << (usage.isMapped ? "mapped from the image file" : "on the heap") << std::endl;
+
+    return 0;
+}